@@ -2,6 +2,7 @@
 #include <QtNodes/DataFlowGraphModel>
 #include <QtNodes/DataFlowGraphicsScene>
 #include <QtNodes/GraphicsView>
+#include <QtNodes/LayeredLayout>
 #include <QtNodes/NodeData>
 #include <QtNodes/NodeDelegateModelRegistry>
 
@@ -10,6 +11,8 @@
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QVBoxLayout>
 
+#include <memory>
+
 #include <QtGui/QScreen>
 
 #include "AdditionModel.hpp"
@@ -23,6 +26,7 @@ using QtNodes::ConnectionStyle;
 using QtNodes::DataFlowGraphicsScene;
 using QtNodes::DataFlowGraphModel;
 using QtNodes::GraphicsView;
+using QtNodes::LayeredLayout;
 using QtNodes::NodeDelegateModelRegistry;
 
 static std::shared_ptr<NodeDelegateModelRegistry> registerDataModels()
@@ -84,12 +88,21 @@ int main(int argc, char *argv[])
     auto loadAction = menu->addAction("Load Scene");
     loadAction->setShortcut(QKeySequence::Open);
 
+    QMenu *layoutMenu = menuBar->addMenu("Layout");
+
+    auto layoutAction = layoutMenu->addAction("Arrange Nodes");
+
+    auto routingAction = layoutMenu->addAction("Orthogonal Connections");
+    routingAction->setCheckable(true);
+
     QVBoxLayout *l = new QVBoxLayout(&mainWidget);
 
     DataFlowGraphModel dataFlowGraphModel(registry);
 
     l->addWidget(menuBar);
     auto scene = new DataFlowGraphicsScene(dataFlowGraphModel, &mainWidget);
+    // Large files open without freezing the window.
+    scene->setIncrementalPopulationEnabled(true);
 
     auto view = new GraphicsView(scene);
     l->addWidget(view);
@@ -103,7 +116,38 @@ int main(int argc, char *argv[])
 
     QObject::connect(loadAction, &QAction::triggered, scene, &DataFlowGraphicsScene::load);
 
-    QObject::connect(scene, &DataFlowGraphicsScene::sceneLoaded, view, &GraphicsView::centerScene);
+    auto layout = new LayeredLayout(*scene, scene);
+
+    QObject::connect(layoutAction, &QAction::triggered, layout, &LayeredLayout::start);
+
+    QObject::connect(routingAction, &QAction::toggled, scene, [scene](bool checked) {
+        scene->setConnectionRouting(checked ? QtNodes::ConnectionRouting::Orthogonal
+                                            : QtNodes::ConnectionRouting::Curved);
+    });
+
+    // A loaded file may still be populating; center once all of it is in the scene.
+    auto centerPending = std::make_shared<bool>(false);
+
+    QObject::connect(scene, &DataFlowGraphicsScene::sceneLoaded, view, [scene, view, centerPending]() {
+        if (scene->isPopulating())
+            *centerPending = true;
+        else
+            view->centerScene();
+    });
+
+    QObject::connect(scene,
+                     &DataFlowGraphicsScene::populationFinished,
+                     view,
+                     [view, centerPending]() {
+                         if (*centerPending) {
+                             *centerPending = false;
+                             view->centerScene();
+                         }
+                     });
+
+    QObject::connect(scene, &DataFlowGraphicsScene::populationCanceled, view, [centerPending]() {
+        *centerPending = false;
+    });
 
     QObject::connect(scene, &DataFlowGraphicsScene::modified, &mainWidget, [&mainWidget]() {
         mainWidget.setWindowModified(true);
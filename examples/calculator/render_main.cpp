@@ -0,0 +1,139 @@
+#include "AdditionModel.hpp"
+#include "DivisionModel.hpp"
+#include "MultiplicationModel.hpp"
+#include "NumberDisplayDataModel.hpp"
+#include "NumberSourceDataModel.hpp"
+#include "SubtractionModel.hpp"
+
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/NodeDelegateModelRegistry>
+#include <QtNodes/SceneRasterizer>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtWidgets/QApplication>
+
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::SceneRasterizer;
+
+static std::shared_ptr<NodeDelegateModelRegistry> registerDataModels()
+{
+    auto ret = std::make_shared<NodeDelegateModelRegistry>();
+    ret->registerModel<NumberSourceDataModel>("Sources");
+
+    ret->registerModel<NumberDisplayDataModel>("Displays");
+
+    ret->registerModel<AdditionModel>("Operators");
+
+    ret->registerModel<SubtractionModel>("Operators");
+
+    ret->registerModel<MultiplicationModel>("Operators");
+
+    ret->registerModel<DivisionModel>("Operators");
+
+    return ret;
+}
+
+/**
+ * Renders a scene saved by the `calculator` example without a display:
+ *
+ *   calculator_render scene.flow out.png --scale 2
+ *   calculator_render scene.flow out.svg
+ *   calculator_render scene.flow tiles/ --tiles --scale 8 --threads 8
+ *
+ * With `--tiles` every tile is written as `tile_<row>_<column>.png` as soon
+ * as it is rendered, so the export size is not limited by memory.
+ */
+int main(int argc, char *argv[])
+{
+    // Widgets embedded in nodes need a platform, but not a display.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders a calculator scene to PNG or SVG.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("scene", "Scene file saved by the calculator example.");
+    parser.addPositionalArgument("output", "Output .png or .svg file, or directory with --tiles.");
+
+    QCommandLineOption scaleOption("scale", "Pixels per scene unit.", "scale", "1");
+    QCommandLineOption tileSizeOption("tile-size", "Tile edge in pixels.", "pixels", "1024");
+    QCommandLineOption threadsOption("threads", "Rasterizer threads.", "count");
+    QCommandLineOption tilesOption("tiles", "Write one PNG per tile into the output directory.");
+
+    parser.addOption(scaleOption);
+    parser.addOption(tileSizeOption);
+    parser.addOption(threadsOption);
+    parser.addOption(tilesOption);
+
+    parser.process(app);
+
+    QStringList const args = parser.positionalArguments();
+
+    if (args.size() != 2)
+        parser.showHelp(1);
+
+    QFile file(args.at(0));
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot open" << args.at(0);
+        return 1;
+    }
+
+    DataFlowGraphModel dataFlowGraphModel(registerDataModels());
+
+    dataFlowGraphModel.load(QJsonDocument::fromJson(file.readAll()).object());
+
+    DataFlowGraphicsScene scene(dataFlowGraphModel);
+
+    SceneRasterizer rasterizer(scene);
+    rasterizer.setScale(parser.value(scaleOption).toDouble());
+    rasterizer.setTileSize(parser.value(tileSizeOption).toInt());
+
+    if (parser.isSet(threadsOption))
+        rasterizer.setThreadCount(parser.value(threadsOption).toInt());
+
+    QString const output = args.at(1);
+
+    qInfo() << "Rendering" << rasterizer.imageSize() << "pixels";
+
+    bool ok = false;
+
+    if (parser.isSet(tilesOption)) {
+        QDir dir(output);
+
+        if (!dir.mkpath(".")) {
+            qWarning() << "Cannot create" << output;
+            return 1;
+        }
+
+        int const tileSize = rasterizer.tileSize();
+
+        ok = rasterizer.renderTiles([&dir, tileSize](QPoint const &offset, QImage const &tile) {
+            QString const name = QString("tile_%1_%2.png")
+                                     .arg(offset.y() / tileSize)
+                                     .arg(offset.x() / tileSize);
+
+            return tile.save(dir.filePath(name), "PNG");
+        });
+    } else if (output.endsWith(".svg", Qt::CaseInsensitive)) {
+        ok = rasterizer.saveSvg(output);
+    } else {
+        ok = rasterizer.savePng(output);
+    }
+
+    if (!ok) {
+        qWarning() << "Rendering to" << output << "failed";
+        return 1;
+    }
+
+    return 0;
+}
@@ -2,6 +2,7 @@
 
 #include "Export.hpp"
 
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -11,6 +12,7 @@
 
 #include "ConnectionIdHash.hpp"
 #include "Definitions.hpp"
+#include "NodeStyle.hpp"
 
 namespace QtNodes {
 
@@ -38,6 +40,13 @@ public:
     /// 返回给定端口的所有已连接 Node Ids。
     virtual std::unordered_set<ConnectionId> connections(NodeId nodeId, PortType portType, PortIndex index) const = 0;
 
+    /**
+     * 返回模型中的全部连接。
+     * 默认实现对每个节点的每个输出端口调用 connections()；能一次枚举全部连接的
+     * 派生类应重写它，场景填充和自动布局都通过它读取连接。
+     */
+    virtual std::unordered_set<ConnectionId> allConnections() const;
+
     /// 检查两个给定 connectionId 的节点是否已连接。
     virtual bool connectionExists(ConnectionId const connectionId) const = 0;
 
@@ -72,6 +81,13 @@ public:
         return NodeFlag::NoFlags;
     }
 
+    /**
+     * 返回节点样式的共享只读句柄，供绘制代码缓存使用。
+     * 默认实现解析 `NodeRole::Style` 的 JSON；派生类可直接返回已有的样式对象以避免解析。
+     * 样式变化时应调用 `StyleCollection::invalidateNodeStyles()` 或发出 `nodeUpdated`。
+     */
+    virtual std::shared_ptr<NodeStyle const> nodeStyle(NodeId nodeId) const;
+
     /// 设置节点属性。
     virtual bool setNodeData(NodeId nodeId, NodeRole role, QVariant value) = 0;
 
@@ -3,10 +3,13 @@
 #include "Definitions.hpp"
 #include "Export.hpp"
 
+#include <QFont>
 #include <QRectF>
 #include <QSize>
 #include <QTransform>
 
+class QWidget;
+
 namespace QtNodes {
 
 class AbstractGraphModel;
@@ -67,6 +70,23 @@ public:
     /// 获取调整大小的手柄矩形。
     virtual QRect resizeHandleRect(NodeId const nodeId) const = 0;
 
+    /**
+     * 丢弃节点的缓存几何数据（端口位置、文字矩形等），下次访问时重新计算。
+     * `recomputeSize` 会重建缓存；默认实现无缓存，不做任何事。
+     */
+    virtual void invalidateCache(NodeId const nodeId) const { Q_UNUSED(nodeId); }
+
+    /// 场景字体变化时调用，派生类据此更新字体度量并丢弃全部缓存。
+    virtual void setFont(QFont const &font) { Q_UNUSED(font); }
+
+protected:
+    /**
+     * 嵌入控件在布局中占用的尺寸。模型给出 `NodeRole::WidgetSizeHint` 时直接使用，
+     * 不会因此创建控件，`widget` 置为 nullptr；否则返回控件的实际尺寸。
+     * 没有嵌入控件时返回无效尺寸。
+     */
+    QSize embeddedWidgetSize(NodeId const nodeId, QWidget **widget = nullptr) const;
+
 protected:
     AbstractGraphModel &_graphModel;
 };
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <QPainter>
+#include <QtCore/QMargins>
 
+#include "Definitions.hpp"
 #include "Export.hpp"
 
 class QPainter;
@@ -25,5 +27,29 @@ public:
    * `NodeGraphicsObject::graphModel()`
    */
     virtual void paint(QPainter *painter, NodeGraphicsObject &ngo) const = 0;
+
+    /**
+   * Called by `NodeGraphicsObject` with the detail tier derived from the
+   * current view scale. The default implementation ignores the tier and
+   * paints the full node. Named apart from `paint()` so that painters
+   * overriding only the two-argument version do not hide it.
+   */
+    virtual void paintWithDetail(QPainter *painter,
+                                 NodeGraphicsObject &ngo,
+                                 LevelOfDetail lod) const
+    {
+        Q_UNUSED(lod);
+        paint(painter, ngo);
+    }
+
+    /**
+   * Area painted around the node geometry, e.g. by a shadow. It is added to
+   * the bounding rect of `NodeGraphicsObject` but not to its shape.
+   */
+    virtual QMarginsF paintMargins(NodeGraphicsObject const &ngo) const
+    {
+        Q_UNUSED(ngo);
+        return QMarginsF();
+    }
 };
 } // namespace QtNodes
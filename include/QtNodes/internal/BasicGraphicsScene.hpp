@@ -1,6 +1,8 @@
 #pragma once
 
+#include <QtCore/QPointer>
 #include <QtCore/QUuid>
+#include <QtGui/QPainterPath>
 #include <QtWidgets/QGraphicsScene>
 #include <QtWidgets/QMenu>
 
@@ -8,22 +10,28 @@
 #include <memory>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "AbstractGraphModel.hpp"
 #include "AbstractNodeGeometry.hpp"
 #include "ConnectionIdHash.hpp"
 #include "Definitions.hpp"
 #include "Export.hpp"
+#include "SpatialIndex.hpp"
 
 #include "QUuidStdHash.hpp"
 
+class QTimer;
 class QUndoStack;
 
 namespace QtNodes {
 
 class AbstractGraphModel;
 class AbstractNodePainter;
+class ConnectionBatchItem;
 class ConnectionGraphicsObject;
+class ConnectionRouter;
 class NodeGraphicsObject;
 class NodeStyle;
 
@@ -84,8 +92,148 @@ public:
 
     // 视图方向
     Qt::Orientation orientation() const { return _orientation; }
+    /// 切换方向时保留现有图形对象及其选中状态，只重新计算节点尺寸、嵌入控件位置和连接路径。
     void setOrientation(Qt::Orientation const orientation);
 
+    /// 场景级细节等级，由视图设置为所有视图中最精细的等级。只决定嵌入控件的创建与显示
+    /// 以及阴影效果；节点和连接绘制时按各自视图的变换计算细节等级。
+    LevelOfDetail levelOfDetail() const { return _levelOfDetail; }
+    /// 切换细节等级；非 Full 等级下关闭节点阴影并隐藏嵌入控件。
+    void setLevelOfDetail(LevelOfDetail const lod);
+
+    /// 节点阴影方式：默认由绘制器使用缓存的预模糊图像绘制；
+    /// 开启后改用每个节点一个 QGraphicsDropShadowEffect（旧行为，每次重绘都要离屏模糊）。
+    bool nodeShadowEffectEnabled() const { return _nodeShadowEffectEnabled; }
+    void setNodeShadowEffectEnabled(bool enabled);
+
+    /// 嵌入控件快照：开启后嵌入控件平时由缓存的像素快照绘制，
+    /// 只有悬停、拥有焦点的节点才显示真实的 QGraphicsProxyWidget；
+    /// 节点内容更新时快照重新抓取。
+    bool widgetSnapshotsEnabled() const { return _widgetSnapshotsEnabled; }
+    void setWidgetSnapshotsEnabled(bool enabled);
+
+public:
+    /// 节点在场景中的包围矩形，由模型位置与节点几何计算，不依赖图形对象。
+    QRectF nodeSceneRect(NodeId const nodeId) const;
+
+    /// 包围矩形与给定场景矩形相交的节点，通过空间索引查询。
+    std::vector<NodeId> nodesInRect(QRectF const &sceneRect) const;
+
+    /// 包围矩形包含给定场景点的节点，通过空间索引查询。
+    std::vector<NodeId> nodesAt(QPointF const &scenePoint) const;
+
+    /// 包围矩形与给定场景矩形相交的连接，通过空间索引查询。
+    std::vector<ConnectionId> connectionsInRect(QRectF const &sceneRect) const;
+
+    /// 按当前模型位置与几何刷新节点的索引矩形。
+    void updateNodeIndex(NodeId const nodeId);
+
+    /// 刷新连接的索引矩形，由 ConnectionGraphicsObject 在几何变化时调用。
+    void updateConnectionIndex(ConnectionId const connectionId, QRectF const &sceneRect);
+
+    SpatialIndex<NodeId> const &nodeIndex() const { return _nodeIndex; }
+
+    SpatialIndex<ConnectionId> const &connectionIndex() const { return _connectionIndex; }
+
+public:
+    /// 视口虚拟化：开启后只为可见区域（含边距）内的节点和连接创建图形对象，
+    /// 移出视口的图形对象回收到对象池中复用。切换时整个场景重新填充。
+    bool virtualizationEnabled() const { return _virtualizationEnabled; }
+    void setVirtualizationEnabled(bool enabled);
+
+    /// 由视图在平移、缩放或尺寸变化时调用，传入当前可见的场景矩形。
+    void setVisibleSceneRect(QRectF const &sceneRect);
+    QRectF visibleSceneRect() const { return _visibleSceneRect; }
+
+    /// 端口在场景中的位置；节点没有图形对象时由模型位置计算。
+    QPointF portScenePosition(NodeId const nodeId,
+                              PortType const portType,
+                              PortIndex const portIndex) const;
+
+    /// 连接在场景中的包围矩形，由两端端口位置计算，不依赖图形对象。
+    QRectF connectionSceneRect(ConnectionId const connectionId) const;
+
+    /// 标记与节点相连的连接需要重新计算端点。
+    /// 同一事件循环内的多次标记合并，每条连接在下一帧绘制前只重新计算一次。
+    void scheduleConnectionUpdate(NodeId const nodeId);
+
+    /// 立即重新计算所有已标记的连接。通常由 scheduleConnectionUpdate() 排入的事件
+    /// 在绘制前执行；需要同步结果时（例如离屏导出、撤销命令）可直接调用。
+    void flushConnectionUpdates();
+
+public:
+    /// 连接批量绘制：开启后连接默认由单个图层项按颜色合并为少量路径绘制，
+    /// 只有悬停、选中或正在交互的连接才拥有独立的 ConnectionGraphicsObject。
+    /// 切换时整个场景重新填充。
+    bool connectionBatchingEnabled() const { return _connectionBatchingEnabled; }
+    void setConnectionBatchingEnabled(bool enabled);
+
+    /// 返回连接的图形对象，批量绘制或虚拟化模式下按需创建。
+    ConnectionGraphicsObject *materializeConnection(ConnectionId const connectionId);
+
+    /// 批量绘制的连接的描边是否与场景区域相交；使用批量图层缓存的描边，不创建图形对象。
+    /// 未开启批量绘制时返回 false。
+    bool batchedConnectionIntersects(ConnectionId const connectionId,
+                                     QPainterPath const &sceneArea) const;
+
+public:
+    /// 连接形状：默认为三次曲线；正交模式下连接由水平和竖直线段组成并绕开节点。
+    /// 路径按连接缓存，端点节点或途经区域内的节点变化时重新计算。
+    /// 切换时保留现有图形对象，只重新计算连接的几何形状。
+    ConnectionRouting connectionRouting() const { return _connectionRouting; }
+    void setConnectionRouting(ConnectionRouting const routing);
+
+    /// 正交模式下让平行的连接尽量共用线段（捆绑）。切换时所有路径重新计算。
+    bool connectionBundlingEnabled() const { return _connectionBundlingEnabled; }
+    void setConnectionBundlingEnabled(bool enabled);
+
+    /// 正交模式下连接的路径（场景坐标），从输出端口到输入端口；曲线模式下返回空路径。
+    QPainterPath connectionRoute(ConnectionId const connectionId) const;
+
+public:
+    /// 分片填充：开启后场景重新填充（模型重置、加载文件等）时，图形对象在多次事件循环中
+    /// 分批创建，每批约 10 毫秒，从可见区域中心由近及远，期间界面保持响应。
+    /// 可见区域不在图的范围内、或由 resumePopulation() 触发（如加载文件）时改从图的中心开始。
+    /// 关闭时（默认）在调用返回前一次性创建完毕。
+    bool incrementalPopulationEnabled() const { return _incrementalPopulationEnabled; }
+    void setIncrementalPopulationEnabled(bool enabled);
+
+    /// 是否仍有节点或连接等待分片创建。
+    bool isPopulating() const { return _population != nullptr; }
+
+    /// 暂停创建图形对象，用于批量修改模型，例如加载文件；可嵌套。
+    /// 最外层的 resumePopulation() 重新填充整个场景，按上面的模式同步或分片进行。
+    void suspendPopulation();
+    void resumePopulation();
+
+    /// 在作用域内暂停填充；析构时恢复，模型操作抛出异常时嵌套层数也保持平衡。
+    class PopulationSuspender
+    {
+    public:
+        explicit PopulationSuspender(BasicGraphicsScene &scene)
+            : _scene(scene)
+        {
+            _scene.suspendPopulation();
+        }
+
+        ~PopulationSuspender() { _scene.resumePopulation(); }
+
+        PopulationSuspender(PopulationSuspender const &) = delete;
+        PopulationSuspender &operator=(PopulationSuspender const &) = delete;
+
+    private:
+        BasicGraphicsScene &_scene;
+    };
+
+public:
+    /// 层级管理：场景只记录当前被提升的节点，提升新节点时恢复旧节点，
+    /// 悬停时无需查询重叠的节点。
+    /// `lowerOthers` 为 false 时保留已提升的节点，用于一次提升一组节点（如粘贴）。
+    void raiseNode(NodeId const nodeId, bool const lowerOthers = true);
+
+    /// 恢复被提升节点的层级；节点未被提升时不做任何事。
+    void lowerNode(NodeId const nodeId);
+
 public:
     // 右键产出的 场景上下文菜单，应于子类中实现
     virtual QMenu *createSceneMenu(QPointF const scenePos);
@@ -111,6 +259,19 @@ Q_SIGNALS:
     void connectionHoverLeft(ConnectionId const connectionId);
     /// 当用户右键点击节点时，触发上下文菜单信号。
     void nodeContextMenu(NodeId const nodeId, QPointF const pos);
+    /// 分片填充进度：已处理的节点与连接数、总数。
+    void populationProgress(int done, int total);
+    /// 场景填充完成，同步填充时也会发出。
+    void populationFinished();
+    /// 分片填充被 cancelPopulation() 或新一轮重新填充中止。
+    void populationCanceled();
+
+protected:
+    /// 场景字体变化时更新节点几何的字体并重新计算所有节点的尺寸。
+    bool event(QEvent *event) override;
+
+    /// 批量绘制模式下，悬停的连接提升为独立图形对象，离开的连接降级回批量图层。
+    void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
     
 private:
     /// 创建节点和连接的图形对象。
@@ -123,6 +284,48 @@ private:
     /// 更新与指定连接ID关联的节点图形。
     void updateAttachedNodes(ConnectionId const connectionId, PortType const portType);
 
+    /// 虚拟化模式下，按可见区域创建或回收节点与连接的图形对象。
+    void updateMaterializedItems();
+
+    /// 为节点创建图形对象，优先从对象池中取出复用。
+    void materializeNode(NodeId const nodeId);
+
+    /// 回收节点的图形对象，嵌入控件归还给模型。
+    void releaseNode(NodeId const nodeId);
+
+    /// 节点被删除或场景析构时，销毁回收时取出、之后未再嵌入的控件。
+    void deleteReleasedWidget(NodeId const nodeId);
+
+    /// 刷新没有图形对象的连接的索引矩形与批量绘制缓存。
+    void updateDetachedConnection(ConnectionId const connectionId);
+
+    /// 端口位置或路由方式整体变化后，丢弃所有连接缓存的路径并刷新其几何形状与索引。
+    void invalidateConnectionGeometry();
+
+    /// 将不再悬停、选中或被抓取的连接图形对象归还给批量图层。
+    void updatePromotedConnections();
+
+    /// 标记途经给定场景矩形的连接需要重新计算路径，与端点更新一起在下一帧前处理。
+    void scheduleRouteUpdate(QRectF const &sceneRect);
+
+    /// 重绘内容已更新的节点，嵌入控件尺寸变化的节点重新布局。
+    void flushContentUpdates();
+
+    struct Population;
+
+    /// 按可见区域中心由近及远排列待创建的节点和连接，开始分片填充。
+    void startPopulation(std::unordered_set<NodeId> const &nodeIds,
+                         std::unordered_set<ConnectionId> const &connectionIds);
+
+    /// 在一个时间片内创建待填充的图形对象，未完成时安排下一批。
+    void populateSlice();
+
+    /// 为节点创建图形对象；虚拟化模式下只登记索引。
+    void populateNode(NodeId const nodeId);
+
+    /// 为连接创建图形对象；虚拟化或批量绘制模式下只登记索引。
+    void populateConnection(ConnectionId const connectionId);
+
 public Q_SLOTS:
     /// 当连接ID从 AbstractGraphModel 中删除时，调用此槽函数。
     void onConnectionDeleted(ConnectionId const connectionId);
@@ -142,12 +345,19 @@ public Q_SLOTS:
     /// 当节点被更新时，调用此槽函数。
     void onNodeUpdated(NodeId const nodeId);
 
+    /// 节点数据变化但几何不变时调用此槽函数：按显示器刷新率合并为一次重绘，
+    /// 只有嵌入控件尺寸变化的节点才重新布局。
+    void onNodeContentUpdated(NodeId const nodeId);
+
     /// 当节点被点击时，调用此槽函数。
     void onNodeClicked(NodeId const nodeId);
 
     /// 当模型被重置时，调用此槽函数。
     void onModelReset();
 
+    /// 中止分片填充；已创建的图形对象保留，其余节点和连接在下次重新填充前不显示。
+    void cancelPopulation();
+
 private:
     // 引用关联的 AbstractGraphModel
     AbstractGraphModel &_graphModel;
@@ -167,6 +377,12 @@ private:
     // 当前草稿连接
     std::unique_ptr<ConnectionGraphicsObject> _draftConnection;
 
+    // 节点包围矩形的空间索引
+    SpatialIndex<NodeId> _nodeIndex;
+
+    // 连接包围矩形的空间索引
+    SpatialIndex<ConnectionId> _connectionIndex;
+
     // 与场景关联的节点几何数据
     std::unique_ptr<AbstractNodeGeometry> _nodeGeometry;
 
@@ -181,6 +397,75 @@ private:
 
     // 场景的方向
     Qt::Orientation _orientation;
+
+    // 当前绘制细节等级
+    LevelOfDetail _levelOfDetail;
+
+    // 是否使用 QGraphicsDropShadowEffect 绘制节点阴影
+    bool _nodeShadowEffectEnabled;
+
+    // 非交互节点的嵌入控件是否由快照绘制
+    bool _widgetSnapshotsEnabled;
+
+    // 是否开启视口虚拟化
+    bool _virtualizationEnabled;
+
+    // 视图最近一次报告的可见场景矩形
+    QRectF _visibleSceneRect;
+
+    // 回收的节点图形对象，隐藏并保留在场景中以便复用
+    std::vector<UniqueNodeGraphicsObject> _nodeGraphicsObjectPool;
+
+    // 回收时从代理中取出的嵌入控件；代理拥有控件，取出后由场景代管
+    std::unordered_map<NodeId, QPointer<QWidget>> _releasedWidgets;
+
+    // 是否开启连接批量绘制
+    bool _connectionBatchingEnabled;
+
+    // 绘制所有未提升连接的图层项
+    std::unique_ptr<ConnectionBatchItem> _connectionBatch;
+
+    // 最近一次悬停的场景坐标，用于判断提升的连接是否仍在鼠标下
+    QPointF _lastHoverScenePos;
+
+    // 连接需要在下一帧前重新计算的节点
+    std::unordered_set<NodeId> _connectionUpdateNodes;
+
+    // 连接形状
+    ConnectionRouting _connectionRouting;
+
+    // 正交模式下是否捆绑平行连接
+    bool _connectionBundlingEnabled;
+
+    // 正交模式下计算并缓存连接路径
+    std::unique_ptr<ConnectionRouter> _connectionRouter;
+
+    // 途经区域内有节点变化、需要在下一帧前重新计算路径的连接
+    std::unordered_set<ConnectionId> _routeUpdateConnections;
+
+    // 内容已更新、等待下一帧重绘的节点
+    std::unordered_set<NodeId> _contentUpdateNodes;
+
+    // 将内容更新限制在显示器刷新率的单次定时器
+    QTimer *_contentUpdateTimer;
+
+    // 当前被提升到其它节点之上的节点，通常只有一个
+    std::vector<NodeId> _raisedNodes;
+
+    // 是否分片填充场景
+    bool _incrementalPopulationEnabled;
+
+    // suspendPopulation() 的嵌套层数
+    int _populationSuspended;
+
+    // 下一次分片填充从图的中心而不是可见区域中心开始，用于 resumePopulation()
+    bool _populationFromContent;
+
+    // 进行中的分片填充，没有时为空
+    std::unique_ptr<Population> _population;
+
+    // 调度下一批分片填充的单次定时器
+    QTimer *_populationTimer;
 };
 
 } // namespace QtNodes
@@ -3,6 +3,7 @@
 #include <utility>
 
 #include <QtCore/QUuid>
+#include <QtGui/QPainterPath>
 #include <QtWidgets/QGraphicsObject>
 
 #include "ConnectionState.hpp"
@@ -49,11 +50,27 @@ public:
 
     std::pair<QPointF, QPointF> pointsC1C2() const;
 
+    /// Curve between the end points in item coordinates: a cubic, or the
+    /// orthogonal route of an established connection when the scene routes
+    /// connections. Cached until an end point, the scene orientation or the
+    /// routing mode changes.
+    QPainterPath const &cubicPath() const;
+
+    /// Control points of the cubic between two end points. Lets the scene
+    /// compute connection bounds for connections without a graphics object.
+    static std::pair<QPointF, QPointF> pointsC1C2(QPointF const &out,
+                                                  QPointF const &in,
+                                                  Qt::Orientation orientation);
+
     void setEndPoint(PortType portType, QPointF const &point);
 
     /// Updates the position of both ends
     void move();
 
+    /// Drops the cached curve even though the ends did not move, e.g. when
+    /// the route has to lead around a node that moved.
+    void invalidateGeometry();
+
     ConnectionState const &connectionState() const;
 
     ConnectionState &connectionState();
@@ -78,9 +95,12 @@ private:
 
     void addGraphicsEffect();
 
-    std::pair<QPointF, QPointF> pointsC1C2Horizontal() const;
+    /// Rebuilds the cached curve and bounds if they are outdated.
+    void ensureGeometry() const;
 
-    std::pair<QPointF, QPointF> pointsC1C2Vertical() const;
+    static std::pair<QPointF, QPointF> pointsC1C2Horizontal(QPointF const &out, QPointF const &in);
+
+    static std::pair<QPointF, QPointF> pointsC1C2Vertical(QPointF const &out, QPointF const &in);
 
 private:
     ConnectionId _connectionId;
@@ -91,6 +111,16 @@ private:
 
     mutable QPointF _out;
     mutable QPointF _in;
+
+    // Geometry cache, invalidated by setEndPoint().
+    mutable bool _geometryValid;
+    mutable bool _strokeValid;
+    mutable Qt::Orientation _geometryOrientation;
+    mutable bool _geometryRouted;
+    mutable std::pair<QPointF, QPointF> _c1c2;
+    mutable QPainterPath _cubicPath;
+    mutable QPainterPath _stroke;
+    mutable QRectF _boundingRect;
 };
 
 } // namespace QtNodes
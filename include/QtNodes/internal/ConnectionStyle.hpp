@@ -1,8 +1,12 @@
 #pragma once
 
 #include <QtGui/QColor>
+#include <QtGui/QPen>
+
+#include <unordered_map>
 
 #include "Export.hpp"
+#include "QStringStdHash.hpp"
 #include "Style.hpp"
 
 namespace QtNodes {
@@ -28,6 +32,8 @@ public:
     QColor constructionColor() const;
     QColor normalColor() const;
     QColor normalColor(QString typeId) const;
+    /// Pen of `lineWidth()` in `normalColor(typeId)`; cached per type id.
+    QPen const &normalPen(QString const &typeId) const;
     QColor selectedColor() const;
     QColor selectedHaloColor() const;
     QColor hoveredColor() const;
@@ -50,5 +56,10 @@ private:
     float PointDiameter;
 
     bool UseDataDefinedColors;
+
+    // Data-defined colors are derived from a hash of the type id; computing
+    // one seeds a random generator, so they are kept per type id.
+    mutable std::unordered_map<QString, QColor> _typeColors;
+    mutable std::unordered_map<QString, QPen> _typePens;
 };
 } // namespace QtNodes
@@ -66,6 +66,13 @@ public:
      * @return std::unordered_set<ConnectionId> 
      */
     std::unordered_set<ConnectionId> connections (NodeId nodeId, PortType portType, PortIndex portIndex) const override;
+
+    /**
+     * @brief 返回全部连接，直接复制连接集合
+     * 
+     * @return std::unordered_set<ConnectionId> 
+     */
+    std::unordered_set<ConnectionId> allConnections() const override;
                                                  
     /**
      * @brief 某ID链接是否存在？
@@ -112,6 +119,9 @@ public:
     /** 为节点配置数据 */
     bool setNodeData(NodeId nodeId, NodeRole role, QVariant value) override;
 
+    /** 节点样式，直接取自 NodeDelegateModel，不经过 JSON */
+    std::shared_ptr<NodeStyle const> nodeStyle(NodeId nodeId) const override;
+
     /** 获取节点 某端口 的数据 */
     QVariant portData(NodeId nodeId,
                       PortType portType,
@@ -205,6 +215,7 @@ private:
     std::unordered_map<NodeId       , std::unique_ptr<NodeDelegateModel>> _models;                    // 节点 数组
     std::unordered_set<ConnectionId> _connectivity;                                                   // 链接 数组
     mutable                          std::unordered_map<NodeId, NodeGeometryData> _nodeGeometryData;  // 节点ID 及其对应的几何数据
+    mutable                          std::unordered_set<NodeId> _embeddedWidgetNodes;                 // 已请求过嵌入控件的节点
 };
 
 } // namespace QtNodes
@@ -4,20 +4,24 @@
 #include "DataFlowGraphModel.hpp"
 #include "Export.hpp"
 
+#include <memory>
+
 namespace QtNodes {
 
+class NodePaletteModel;
+
 // 视图类
 class NODE_EDITOR_PUBLIC DataFlowGraphicsScene : public BasicGraphicsScene
 {
     Q_OBJECT
 public:
     DataFlowGraphicsScene(DataFlowGraphModel &graphModel, QObject *parent = nullptr);
-    ~DataFlowGraphicsScene() = default;
+    ~DataFlowGraphicsScene();
 public:
     std::vector<NodeId> selectedNodes() const;
 
 public:
-    // 菜单
+    // 菜单；模型列表按注册表版本缓存，注册表不变时只重置过滤条件
     QMenu *createSceneMenu(QPointF const scenePos) override;
 
 public Q_SLOTS:
@@ -30,15 +34,22 @@ public Q_SLOTS:
     }
     void load_SetJson(QJsonObject const &json) {
         clearScene();
-        _graphModel.load(json);
+        // 加载完成后一次性填充场景，而不是每个节点单独创建图形对象
+        {
+            PopulationSuspender suspender(*this);
+            _graphModel.load(json);
+        }
         Q_EMIT sceneLoaded();
     }
 
 Q_SIGNALS:
+    /// 模型加载完成；分片填充模式下图形对象可能仍在创建，完成时发出 populationFinished()。
     void sceneLoaded();
 
 private:
     DataFlowGraphModel &_graphModel;
+
+    std::unique_ptr<NodePaletteModel> _paletteModel;
 };
 
 } // namespace QtNodes
@@ -19,6 +19,16 @@ class NODE_EDITOR_PUBLIC DefaultNodePainter : public AbstractNodePainter
 public:
     // 重写的 paint 函数，负责绘制节点
     void paint(QPainter *painter, NodeGraphicsObject &ngo) const override;
+    // 按细节等级绘制节点，缩放较小时跳过文字与渐变
+    void paintWithDetail(QPainter *painter,
+                         NodeGraphicsObject &ngo,
+                         LevelOfDetail lod) const override;
+    // 未启用 QGraphicsDropShadowEffect 时，为绘制的阴影预留边距
+    QMarginsF paintMargins(NodeGraphicsObject const &ngo) const override;
+    // 绘制节点阴影：使用按（尺寸档位、颜色、模糊半径）缓存的预模糊九宫格图像
+    void drawNodeShadow(QPainter *painter, NodeGraphicsObject &ngo) const;
+    // 绘制不带渐变与圆角的节点外框，用于低细节等级
+    void drawFlatNodeRect(QPainter *painter, NodeGraphicsObject &ngo, bool withBoundary) const;
     // 绘制节点的矩形边框
     void drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo) const;
     // 绘制连接点
@@ -32,7 +32,8 @@ Q_NAMESPACE_EXPORT(NODE_EDITOR_PUBLIC)
         InPortCount             = 7,    ///< `unsigned int`
         OutPortCount            = 9,    ///< `unsigned int`
         Widget                  = 10,   ///< Optional `QWidget*` or `nullptr`
-        Widget_detailedSettings = 11    /// 详细配置窗口
+        Widget_detailedSettings = 11,   /// 详细配置窗口
+        WidgetSizeHint          = 12    ///< `QSize` 嵌入控件尚未创建时用于布局的尺寸，无效则立即创建控件
     };
 Q_ENUM_NS(NodeRole)
 
@@ -80,6 +81,26 @@ enum class PortType {
 };
 Q_ENUM_NS(PortType)
 
+/**
+ * Rendering detail tiers selected from the view scale. The thresholds are
+ * configured in `GraphicsViewStyle`.
+ */
+enum class LevelOfDetail {
+    Full = 0,       ///< Everything is drawn.
+    Simplified = 1, ///< Flat node rect, no text.
+    Minimal = 2,    ///< Filled box, straight-line connections.
+};
+Q_ENUM_NS(LevelOfDetail)
+
+/**
+ * Shape of the connections between nodes, selected per scene.
+ */
+enum class ConnectionRouting {
+    Curved = 0,     ///< Cubic curve between the ports.
+    Orthogonal = 1, ///< Horizontal and vertical segments leading around nodes.
+};
+Q_ENUM_NS(ConnectionRouting)
+
 using PortCount = unsigned int;
 
 /// ports are consecutively numbered starting from zero.
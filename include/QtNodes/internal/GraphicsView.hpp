@@ -1,8 +1,20 @@
 #pragma once
 
+#include <QtCore/QElapsedTimer>
+#include <QtGui/QColor>
+#include <QtGui/QPixmap>
 #include <QtWidgets/QGraphicsView>
+#include "Definitions.hpp"
 #include "Export.hpp"
 
+#include <array>
+#include <deque>
+#include <map>
+#include <unordered_set>
+
+class QRubberBand;
+class QTimer;
+
 namespace QtNodes {
 
 class BasicGraphicsScene;
@@ -24,6 +36,25 @@ public:
         double minimum = 0; ///< 最小缩放比例
         double maximum = 0; ///< 最大缩放比例
     };
+
+    /**
+     * @brief 帧统计。帧率与帧耗时分位数基于最近的若干帧，只重绘统计浮层的帧不计入。
+     * 节点与连接的绘制次数只统计本视图最近一帧的绘制；recomputeSize 与
+     * moveConnections 次数发生在事件处理中，无法归属到某个视图，为进程内的全局计数
+     * （含其他视图和离屏导出），自本视图上一帧结束起累计。
+     */
+    struct FrameStatistics
+    {
+        double framesPerSecond = 0;         ///< 统计窗口内的帧率
+        double frameTimeP50 = 0;            ///< 帧耗时中位数（毫秒）
+        double frameTimeP90 = 0;            ///< 帧耗时 90 分位（毫秒）
+        double frameTimeP99 = 0;            ///< 帧耗时 99 分位（毫秒）
+        double backgroundTime = 0;          ///< drawBackground 耗时（毫秒）
+        quint64 nodePaints = 0;             ///< 节点绘制次数
+        quint64 connectionPaints = 0;       ///< 连接绘制次数（含批量图层中的连接）
+        quint64 recomputeSizeCalls = 0;     ///< 节点几何 recomputeSize 调用次数
+        quint64 moveConnectionsCalls = 0;   ///< NodeGraphicsObject::moveConnections 调用次数
+    };
 public:
 
     // construct
@@ -44,6 +75,10 @@ public:
     // 调整视图（GraphicsView），使场景（scene）位于视图的中心
     void centerScene();
 
+    /// 将节点移到视图中心并只选中该节点，不改变缩放比例；
+    /// 虚拟化场景中节点随之实例化。节点不存在时不做任何事。
+    void centerOnNode(NodeId const nodeId);
+
     // 设置缩放范围
     void setScaleRange(double minimum = 0, double maximum = 0);
     void setScaleRange(ScaleRange range);
@@ -51,6 +86,13 @@ public:
     // 当前缩放比例
     double getScale() const;
 
+    /// 最近若干帧的绘制统计。
+    FrameStatistics frameStatistics() const;
+
+    /// 是否在视图左上角显示帧统计。
+    bool statisticsOverlayEnabled() const { return _statisticsOverlayEnabled; }
+    void setStatisticsOverlayEnabled(bool enabled);
+
 public Q_SLOTS:
     /**
      * @brief 放大视图。
@@ -120,6 +162,12 @@ protected:
      */
     void mouseMoveEvent(QMouseEvent *event) override;
 
+    /**
+     * @brief 重写鼠标释放事件。
+     * @param event 鼠标释放事件。
+     */
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
     /**
      * @brief 重写绘制背景事件。
      * @param painter 绘图对象。
@@ -127,12 +175,36 @@ protected:
      */
     void drawBackground(QPainter *painter, const QRectF &r) override;
 
+    /**
+     * @brief 重写绘制前景，开启统计显示时绘制帧统计。
+     * @param painter 绘图对象。
+     * @param r 绘制区域。
+     */
+    void drawForeground(QPainter *painter, const QRectF &r) override;
+
+    /**
+     * @brief 重写绘制事件，绘制前重新计算场景中待更新的连接。
+     * @param event 绘制事件。
+     */
+    void paintEvent(QPaintEvent *event) override;
+
     /**
      * @brief 重写显示事件。
      * @param event 显示事件。
      */
     void showEvent(QShowEvent *event) override;
 
+    /**
+     * @brief 重写尺寸变化事件，向场景报告新的可见区域。
+     * @param event 尺寸变化事件。
+     */
+    void resizeEvent(QResizeEvent *event) override;
+
+    /**
+     * @brief 重写视口滚动，向场景报告新的可见区域。
+     */
+    void scrollContentsBy(int dx, int dy) override;
+
 protected:
     /**
      * @brief 获取当前场景对象。
@@ -144,6 +216,33 @@ protected:
      * @return 计算得到的场景粘贴位置 */
     QPointF scenePastePosition();
 
+private:
+    /**
+     * @brief 按场景所有视图中最精细的缩放比例更新场景的细节等级。*/
+    void updateLevelOfDetail();
+
+    /**
+     * @brief 向场景报告当前可见的场景矩形，供视口虚拟化使用。*/
+    void updateVisibleSceneRect();
+
+    /**
+     * @brief 按当前框选区域更新选中项，通过场景空间索引查询候选项。*/
+    void updateRubberBandSelection(QPoint const &viewPos);
+
+    /**
+     * @brief 返回覆盖一个粗网格单元的网格贴图，按设备像素尺寸缓存。
+     * @param tileSize 贴图边长（设备像素）。
+     * @param drawFine 是否绘制细网格线。*/
+    QPixmap const &gridTile(int tileSize, bool drawFine);
+
+    /**
+     * @brief 绘制背景色与网格，drawBackground 在其外计时。*/
+    void drawGridBackground(QPainter *painter, const QRectF &r);
+
+    /**
+     * @brief 统计显示在视口中占用的矩形。*/
+    QRect statisticsOverlayRect() const;
+
 private:
     QAction *_clearSelectionAction     = nullptr;  ///< 清除选中项的动作
     QAction *_deleteSelectionAction    = nullptr;  ///< 删除选中项的动作
@@ -153,6 +252,23 @@ private:
 
     QPointF    _clickPos;    ///< 鼠标点击位置
     ScaleRange _scaleRange;  ///< 缩放范围
+
+    QRubberBand *_rubberBand = nullptr;  ///< Shift 框选时显示的选框
+    QPoint _rubberBandOrigin;            ///< 框选起点（视图坐标）
+    std::unordered_set<QGraphicsItem *> _rubberBandBaseSelection; ///< 框选开始前保留的选中项
+
+    std::map<std::pair<int, bool>, QPixmap> _gridTiles; ///< 按缩放档位缓存的网格贴图
+    QColor _gridTileFineColor;                          ///< 缓存贴图使用的细网格颜色
+    QColor _gridTileCoarseColor;                        ///< 缓存贴图使用的粗网格颜色
+
+    QElapsedTimer _frameClock;                          ///< 帧时间戳的时钟
+    std::deque<std::pair<qint64, double>> _frames;      ///< 最近帧的开始时间（纳秒）与耗时（毫秒）
+    std::array<quint64, 4> _frameCounters{};            ///< 最近一帧的绘制计数
+    std::array<quint64, 4> _counterSnapshot{};          ///< 上一帧开始或结束时的计数器读数
+    qint64 _backgroundNanoseconds = 0;                  ///< 当前帧 drawBackground 累计耗时
+    qint64 _lastBackgroundNanoseconds = 0;              ///< 最近一帧 drawBackground 耗时
+    bool _statisticsOverlayEnabled = false;             ///< 是否显示帧统计
+    QTimer *_statisticsOverlayTimer = nullptr;          ///< 定期刷新统计显示
 };
 
 } // namespace QtNodes
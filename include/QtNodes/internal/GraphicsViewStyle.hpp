@@ -2,6 +2,7 @@
 
 #include <QtGui/QColor>
 
+#include "Definitions.hpp"
 #include "Export.hpp"
 #include "Style.hpp"
 
@@ -19,6 +20,9 @@ public:
 public:
     static void setStyle(QString jsonText);
 
+    /// 根据视图缩放比例选择绘制细节等级。
+    LevelOfDetail levelOfDetail(double scale) const;
+
 private:
     void loadJson(QJsonObject const &json) override;
 
@@ -28,5 +32,10 @@ public:
     QColor BackgroundColor;
     QColor FineGridColor;
     QColor CoarseGridColor;
+
+    /// 缩放比例低于该值时节点只绘制简化外框，不绘制文字。
+    float SimplifiedDetailScale;
+    /// 缩放比例低于该值时节点只绘制色块，连线绘制为直线。
+    float MinimalDetailScale;
 };
 } // namespace QtNodes
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QPointF>
+#include <QtCore/QSizeF>
+#include <QtCore/QThreadPool>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Definitions.hpp"
+#include "Export.hpp"
+
+namespace QtNodes {
+
+class BasicGraphicsScene;
+
+/**
+ * @brief 分层（Sugiyama）自动布局。
+ *
+ * 依次执行：反转回边以消除环、按最长路径分层（长连接插入虚拟节点）、
+ * 按重心法逐层扫描减少交叉、在保持层内顺序与最小间距的前提下对齐相连节点。
+ * 层的方向跟随场景方向：水平场景中层从左到右排列，垂直场景中从上到下排列；
+ * 节点尺寸取自 AbstractNodeGeometry::size。
+ *
+ * 节点和连接在调用线程上读取一次，计算只使用这份快照；节点数达到阈值时在
+ * 后台线程计算，期间场景保持可交互。结果作为一条撤销命令一次性写回模型，
+ * 计算期间被删除的节点会被跳过。
+ */
+class NODE_EDITOR_PUBLIC LayeredLayout : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LayeredLayout(BasicGraphicsScene &scene, QObject *parent = nullptr);
+
+    /// 取消未完成的计算并等待后台线程退出。
+    ~LayeredLayout();
+
+public:
+    /// 相邻两层之间的距离，默认 80。
+    double layerSpacing() const { return _layerSpacing; }
+    void setLayerSpacing(double spacing);
+
+    /// 同一层内相邻节点之间的距离，默认 30。
+    double nodeSpacing() const { return _nodeSpacing; }
+    void setNodeSpacing(double spacing);
+
+    /// 达到该节点数时在后台线程计算，默认 1000。
+    int threadThreshold() const { return _threadThreshold; }
+    void setThreadThreshold(int nodeCount);
+
+    bool isRunning() const { return _job != nullptr; }
+
+public Q_SLOTS:
+    /// 对场景中的所有节点布局；已有计算在进行时先取消它。
+    /// 节点数低于阈值时同步完成，返回前已写回结果并发出 finished()。
+    void start();
+
+    /// 取消未完成的计算，不写回任何结果。
+    void cancel();
+
+Q_SIGNALS:
+    /// 布局结果已写回模型。
+    void finished();
+
+public:
+    /// 计算使用的图快照，节点以下标表示。
+    struct Graph
+    {
+        /// 节点尺寸。
+        std::vector<QSizeF> sizes;
+
+        /// 由输出端节点指向输入端节点的边。
+        std::vector<std::pair<int, int>> edges;
+    };
+
+    /**
+     * 计算节点左上角坐标，左上角对齐到原点。
+     * 纯计算，不访问场景或模型，可在任意线程调用；`canceled` 置位时提前返回空结果。
+     */
+    static std::vector<QPointF> computePositions(Graph const &graph,
+                                                 Qt::Orientation const orientation,
+                                                 double const layerSpacing,
+                                                 double const nodeSpacing,
+                                                 std::atomic<bool> const &canceled);
+
+private:
+    struct Job;
+
+    void apply(std::shared_ptr<Job> const &job);
+
+private:
+    BasicGraphicsScene &_scene;
+
+    double _layerSpacing;
+
+    double _nodeSpacing;
+
+    int _threadThreshold;
+
+    // 当前计算；完成、取消后置空
+    std::shared_ptr<Job> _job;
+
+    // 单线程的计算池，析构时等待其完成
+    QThreadPool _pool;
+};
+
+} // namespace QtNodes
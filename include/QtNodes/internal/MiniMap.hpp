@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QtCore/QPointer>
+#include <QtCore/QRectF>
+#include <QtGui/QImage>
+#include <QtGui/QTransform>
+#include <QtWidgets/QWidget>
+
+#include "Definitions.hpp"
+#include "Export.hpp"
+#include "SpatialIndex.hpp"
+
+namespace QtNodes {
+
+class BasicGraphicsScene;
+class GraphicsView;
+
+/**
+ * @brief 场景缩略图。
+ *
+ * 节点按模型中的位置和尺寸绘制为色块，缓存在一张与控件同尺寸的低分辨率图像中；
+ * 节点创建、删除、移动或尺寸变化时只重绘受影响的区域。节点移出当前范围时，
+ * 范围按比例留出余量地扩大后整幅重绘，因此向外拖动节点只会偶尔触发重绘；
+ * 范围只在重建（绑定场景、模型重置、控件尺寸变化）时收缩。
+ * 绘制从不经过节点绘制器或图形项。
+ *
+ * 绑定视图后显示视图的可见区域，点击或拖动时将视图居中到对应的场景位置。
+ */
+class NODE_EDITOR_PUBLIC MiniMap : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit MiniMap(QWidget *parent = nullptr);
+
+    MiniMap(BasicGraphicsScene *scene, GraphicsView *view, QWidget *parent = nullptr);
+
+public:
+    /// 绑定场景；传入 nullptr 解除绑定。
+    void setScene(BasicGraphicsScene *scene);
+
+    /// 绑定视图，用于显示可见区域和点击导航；传入 nullptr 解除绑定。
+    void setView(GraphicsView *view);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+    void resizeEvent(QResizeEvent *event) override;
+
+    void mousePressEvent(QMouseEvent *event) override;
+
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+    /// 视图视口重绘或尺寸变化时刷新可见区域框。
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    /// 节点在场景中的矩形，只读取模型位置和几何尺寸。
+    QRectF nodeRect(NodeId const nodeId) const;
+
+    /// 重新收集所有节点，并按其范围重新计算映射后整幅重绘。
+    void rebuild();
+
+    /// 以场景范围 `sceneRect` 重新计算映射并整幅重绘，不重新收集节点。
+    void remap(QRectF const &sceneRect);
+
+    /// 将范围扩大到覆盖所有节点并留出余量。
+    void grow();
+
+    /// 在下一次事件循环中扩大范围；在此之前的节点变化只更新索引。
+    void scheduleGrow();
+
+    /// 重绘缓存图像中与场景矩形 `sceneRect` 对应的区域。
+    void redraw(QRectF const &sceneRect);
+
+    /// 节点矩形变化后更新索引并重绘新旧区域。
+    void updateNode(NodeId const nodeId);
+
+    void removeNode(NodeId const nodeId);
+
+    void centerViewOn(QPoint const &pos);
+
+private:
+    QPointer<BasicGraphicsScene> _scene;
+
+    QPointer<GraphicsView> _view;
+
+    /// 缩略图自己的节点索引，矩形为不含边距的节点矩形。
+    SpatialIndex<NodeId> _nodes;
+
+    /// 缓存图像覆盖的场景范围。
+    QRectF _sceneRect;
+
+    /// 场景坐标到缓存图像坐标的映射。
+    QTransform _sceneToImage;
+
+    QImage _image;
+
+    /// 已安排扩大范围，尚未执行。
+    bool _growPending;
+};
+
+} // namespace QtNodes
@@ -81,10 +81,14 @@ public:
     /// @return 
     virtual ConnectionPolicy portConnectionPolicy(PortType, PortIndex) const;
 
-    /// @brief 获取节点的样式
+    /// @brief 获取节点的样式，未单独设置时为全局样式
     /// @return 
     NodeStyle const &nodeStyle() const;
 
+    /// @brief 获取节点样式的共享只读句柄，供绘制缓存使用
+    /// @return 
+    std::shared_ptr<NodeStyle const> sharedNodeStyle() const;
+
     /// @brief 设置节点的样式
     /// @param style 
     void setNodeStyle(NodeStyle const &style);
@@ -121,6 +125,13 @@ public:
     // 用于展示详细配置界面
     virtual QWidget *detailedSettingsWidget() = 0;
 
+    /**
+     * 嵌入控件的预估尺寸。返回有效尺寸时，场景在节点可见且缩放到
+     * 完整细节等级之前不会调用 `embeddedWidget()`，布局按此尺寸计算。
+     * 默认返回无效尺寸，控件随节点图形对象一起创建。
+     */
+    virtual QSize embeddedWidgetSizeHint() const { return QSize(); }
+
 
     /// @brief 判断控件是否可调整大小
     /// @return 
@@ -159,6 +170,9 @@ Q_SIGNALS:
 
     /// @brief 当嵌入式控件大小更新时触发此信号
     void embeddedWidgetSizeUpdated();
+
+    /// @brief 当 setNodeStyle() 更换节点样式时触发此信号
+    void nodeStyleUpdated();
     
     /// Call this function before deleting the data associated with ports.
     /** 
@@ -191,8 +205,8 @@ Q_SIGNALS:
     void portsInserted();
 
 private:
-    /// @brief 保存节点样式
-    NodeStyle _nodeStyle;
+    /// @brief 节点自定义样式，为空时使用 StyleCollection 的全局样式
+    std::shared_ptr<NodeStyle const> _nodeStyle;
 };
 
 } // namespace QtNodes
@@ -57,6 +57,8 @@ void registerModel(RegistryItemCreator creator, QString const &category = "Nodes
         // 将模型的名称和类别关联并存储在 `_registeredModelsCategory` 映射中
         // 这样可以方便以后通过名称找到模型的类别
         _registeredModelsCategory[name] = category;
+
+        ++_version;
     }
 }
 
@@ -150,6 +152,8 @@ void unRegisterModel(RegistryItemCreator creator, QString const &category = "Nod
         // 这样可以方便以后通过名称找到模型的类别
         // _registeredModelsCategory[name] = category;
         _registeredModelsCategory.erase(name);
+
+        ++_version;
     }
 }
 
@@ -198,6 +202,9 @@ void unRegisterModel(RegistryItemCreator creator, QString const &category = "Nod
 
     CategoriesSet const &categories() const;
 
+    /// 每次注册或注销模型后递增，供缓存注册表内容的一方判断是否需要重建。
+    std::size_t version() const;
+
 #if 0
   TypeConverter
   getTypeConverter(NodeDataType const& d1,
@@ -211,6 +218,8 @@ private:
 
     RegisteredModelCreatorsMap _registeredItemCreators;
 
+    std::size_t _version = 0;
+
 #if 0
   RegisteredTypeConvertersMap _registeredTypeConverters;
 #endif
@@ -1,11 +1,16 @@
 #pragma once
 
 #include <QtCore/QUuid>
+#include <QtGui/QPixmap>
 #include <QtWidgets/QGraphicsObject>
 
+#include <memory>
+
 #include "NodeState.hpp"
+#include "NodeStyle.hpp"
 
 class QGraphicsProxyWidget;
+class QWidget;
 
 namespace QtNodes {
 
@@ -49,14 +54,59 @@ public:
     NodeState &nodeState() { return _nodeState; }
     NodeState const &nodeState() const { return _nodeState; }
 
-    // 边界矩形
+    // 节点样式，缓存模型提供的共享样式，样式版本变化时重新获取
+    NodeStyle const &nodeStyle() const;
+    // 丢弃缓存的节点样式，下次访问时重新从模型获取
+    void invalidateNodeStyle() { _nodeStyle.reset(); }
+
+    // 边界矩形，包含绘制器在节点几何之外绘制的区域（如阴影）
     QRectF boundingRect() const override;
+    // 命中区域，不含阴影等绘制边距
+    QPainterPath shape() const override;
     // 节点几何变化标志
     void setGeometryChanged();
-    // 访问所有附加的连接
+    // 访问所有附加的连接，由场景合并到下一帧绘制前统一重新计算
     void moveConnections() const;
 
     void reactToConnection(ConnectionGraphicsObject const *cgo);
+
+    /// 按细节等级开关阴影效果与嵌入控件，低细节等级下两者都不可见。
+    void applyLevelOfDetail(LevelOfDetail lod);
+
+    /** @brief 按节点样式设置阴影与透明度。
+     *  场景选择 QGraphicsDropShadowEffect 时创建该效果，否则移除效果，阴影由绘制器绘制。
+     */
+    void applyNodeStyle();
+
+    /** @brief 将对象重新绑定到另一个节点。
+     *  用于虚拟化场景中复用对象池里的图形对象：释放旧节点的嵌入控件，
+     *  重置状态，并按新节点的样式、控件和位置重新初始化。
+     */
+    void setNodeId(NodeId const nodeId);
+
+    /** @brief 从代理中取出嵌入控件但不销毁它，返回取出的控件（没有时为 nullptr）。
+     *  节点仍在模型中、只是图形对象被回收时调用；控件由场景代管，
+     *  节点删除或场景析构时若仍未重新嵌入则由场景销毁。
+     */
+    QWidget *releaseEmbeddedWidget();
+
+    /** @brief 嵌入控件的尺寸自上次调用（或嵌入）以来是否变化，并记录当前尺寸。
+     *  用于区分只需重绘的内容更新与需要重新布局的几何更新。
+     */
+    bool embeddedWidgetResized();
+
+    /** @brief 按当前节点几何放置嵌入控件，例如场景方向切换之后。
+     */
+    void updateEmbeddedWidgetGeometry();
+
+    /** @brief 按细节等级、快照模式、悬停和焦点状态决定显示真实控件还是快照。
+     *  延迟创建的控件在节点可见且处于完整细节等级时于此嵌入。
+     */
+    void updateEmbeddedWidgetVisibility();
+
+    /** @brief 丢弃嵌入控件的快照，下次绘制时重新抓取。
+     */
+    void invalidateWidgetSnapshot();
 protected:
     /**
      * @brief 绘制节点的方法。
@@ -127,6 +177,11 @@ private:
      */
     void embedQWidget();
 
+    /** @brief 模型声明了控件尺寸提示，且节点当前不可见或细节等级不足时，推迟创建控件。
+     *  尚无视图报告可见区域时也推迟，由场景收到第一个可见区域后嵌入。
+     */
+    bool embeddedWidgetDeferred() const;
+
     /** @brief 设置锁定状态。
      *  锁定或解锁节点，以防止或允许用户交互。
      */
@@ -139,5 +194,14 @@ private:
     
     /// 要么是 nullptr，要么由父类 QGraphicsItem 所拥有
     QGraphicsProxyWidget *_proxyWidget; 
+
+    QSize _embeddedWidgetSize;        ///< 最近一次布局时嵌入控件的尺寸。
+
+    bool _embeddedWidgetPending;      ///< 嵌入控件被推迟创建，尚未嵌入。
+
+    QPixmap _widgetSnapshot;          ///< 代理隐藏时代替嵌入控件绘制的快照。
+
+    mutable std::shared_ptr<NodeStyle const> _nodeStyle; ///< 缓存的节点样式。
+    mutable unsigned int _nodeStyleVersion;              ///< 缓存样式对应的样式版本。
 };
 } // namespace QtNodes
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Definitions.hpp"
+#include "Export.hpp"
+#include "QStringStdHash.hpp"
+
+namespace QtNodes {
+
+class AbstractGraphModel;
+
+/**
+ * @brief 节点搜索索引。
+ *
+ * 为每个节点收集检索词：标题、类型、节点 ID 以及用户标签，标题和类型还按单词拆分。
+ * 检索词不区分大小写，保存在有序表中用于前缀查询，并按三元组（trigram）建立
+ * 倒排索引用于模糊查询。倒排索引以去重后的检索词为单位，同类节点再多也只占一项。
+ *
+ * 索引随模型的节点创建、删除、更新和重置增量维护。
+ * 配合 GraphicsView::centerOnNode() 跳转到查询结果。
+ */
+class NODE_EDITOR_PUBLIC NodeSearchIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NodeSearchIndex(AbstractGraphModel &graphModel, QObject *parent = nullptr);
+
+public:
+    /// 节点的用户标签，参与检索；节点删除时一并丢弃。
+    QStringList tags(NodeId const nodeId) const;
+    void setTags(NodeId const nodeId, QStringList const &tags);
+
+    /**
+     * 按相关度返回至多 `maxResults` 个节点：
+     * 与检索词完全相同的排在最前，其次是前缀匹配（检索词越短越靠前），
+     * 最后是三元组相似度不低于阈值的模糊匹配。相关度相同时按节点 ID 排序。
+     */
+    std::vector<NodeId> search(QString const &query, std::size_t maxResults = 50) const;
+
+private:
+    /// 重新收集节点的检索词；检索词未变化时不做任何事。
+    void indexNode(NodeId const nodeId);
+
+    void removeNode(NodeId const nodeId);
+
+    /// 模型重置后重建索引，保留仍存在的节点的标签。
+    void rebuild();
+
+    std::vector<QString> collectTerms(NodeId const nodeId, QStringList const &tags) const;
+
+    void addTerm(QString const &term, NodeId const nodeId);
+
+    void removeTerm(QString const &term, NodeId const nodeId);
+
+private:
+    struct Entry
+    {
+        std::vector<QString> terms;
+        QStringList tags;
+    };
+
+    struct Term
+    {
+        std::unordered_set<NodeId> nodes;
+
+        /// 检索词的三元组个数，用于计算模糊匹配的相似度。
+        std::size_t trigramCount = 0;
+    };
+
+    AbstractGraphModel &_graphModel;
+
+    std::unordered_map<NodeId, Entry> _entries;
+
+    /// 检索词到节点的映射，按检索词排序以支持前缀查询。
+    std::map<QString, Term> _terms;
+
+    /// 三元组到包含它的检索词的映射。
+    std::unordered_map<quint64, std::unordered_set<QString>> _trigrams;
+};
+
+} // namespace QtNodes
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QtCore/QPoint>
+#include <QtCore/QRectF>
+#include <QtCore/QSize>
+#include <QtGui/QColor>
+#include <QtGui/QImage>
+
+#include <functional>
+
+#include "Export.hpp"
+
+class QString;
+
+namespace QtNodes {
+
+class BasicGraphicsScene;
+
+/**
+ * 将场景离屏渲染为图像，适用于缩略图和超大尺寸导出（例如 offscreen 平台下的服务器）。
+ *
+ * 图像按固定尺寸的图块渲染：每个图块在调用线程上通过 QGraphicsScene::render
+ * 录制为 QPicture（节点与连接仍由 AbstractNodePainter 和 ConnectionPainter 绘制），
+ * 再由线程池中的线程光栅化。图元只能在所属线程上绘制，因此录制始终是串行的，
+ * 线程池只分担回放（抗锯齿填充与文字光栅化）这部分开销。
+ *
+ * renderTiles() 同时在途的图块数量有上限，其内存占用只与图块尺寸和线程数有关，
+ * 与整幅图像的尺寸无关；renderImage() 和 savePng() 则需要容纳整幅图像。
+ *
+ * 渲染期间可见区域随图块移动：虚拟化场景按图块把节点实例化，延迟创建的嵌入控件
+ * 也在其所在图块渲染前创建（未绑定视图的场景同样如此）。渲染结束后恢复原来的
+ * 可见区域与细节等级。
+ */
+class NODE_EDITOR_PUBLIC SceneRasterizer
+{
+public:
+    /// 接收一个渲染好的图块，`offset` 为图块在整幅图像中的像素位置。
+    /// 图块按行优先顺序交付；返回 false 时中止渲染。
+    using TileSink = std::function<bool(QPoint const &offset, QImage const &tile)>;
+
+public:
+    explicit SceneRasterizer(BasicGraphicsScene &scene);
+
+public:
+    /// 要渲染的场景区域。默认为所有节点与连接的包围矩形。
+    QRectF sourceRect() const;
+    void setSourceRect(QRectF const &sceneRect);
+
+    /// 每个场景单位对应的像素数，默认为 1。
+    double scale() const { return _scale; }
+    void setScale(double scale);
+
+    /// 图块边长（像素），默认 1024。
+    int tileSize() const { return _tileSize; }
+    void setTileSize(int tileSize);
+
+    /// 回放录制好的图块的线程数，默认为 QThread::idealThreadCount()。
+    /// 录制本身在调用线程上串行进行，所以加速上限取决于回放在单个图块耗时中的占比；
+    /// 图元数量多、绘制简单的场景几乎得不到加速。
+    /// 为 1 时直接在调用线程上渲染，不经过 QPicture。
+    int threadCount() const { return _threadCount; }
+    void setThreadCount(int threadCount);
+
+    /// 图块的背景色，默认为视图样式的背景色。
+    QColor backgroundColor() const { return _backgroundColor; }
+    void setBackgroundColor(QColor const &color);
+
+    /// 按当前区域和缩放比例计算的整幅图像尺寸。
+    QSize imageSize() const;
+
+public:
+    /// 按行优先顺序渲染所有图块并逐个交给 `sink`。全部图块交付完成时返回 true。
+    bool renderTiles(TileSink const &sink);
+
+    /// 渲染整幅图像；图像尺寸受 QImage 的上限约束，超大导出请使用 renderTiles()。
+    QImage renderImage();
+
+    /// 渲染并保存为 PNG。Qt 的 PNG 编码器不支持逐行写入，整幅图像会先完整地保存在内存中
+    /// 再编码，因此受 renderImage() 相同的尺寸上限约束；需要流式导出时，
+    /// 请通过 renderTiles() 把图块交给支持逐行写入的编码器。
+    bool savePng(QString const &fileName);
+
+    /// 以矢量形式保存为 SVG；库未链接 Qt Svg 模块时返回 false。
+    bool saveSvg(QString const &fileName);
+
+private:
+    QImage renderTile(QRectF const &sceneRect, QSize const &size) const;
+
+private:
+    BasicGraphicsScene &_scene;
+
+    QRectF _sourceRect;
+
+    double _scale;
+
+    int _tileSize;
+
+    int _threadCount;
+
+    QColor _backgroundColor;
+};
+
+} // namespace QtNodes
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <QtCore/QRect>
+#include <QtCore/QRectF>
+#include <QtCore/QtGlobal>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace QtNodes {
+
+/**
+ * 场景元素的均匀网格空间索引。
+ *
+ * 每个元素按其场景包围矩形登记到覆盖的网格单元中；覆盖单元过多的大元素
+ * （例如跨越整个场景的长连线）单独存放，查询时线性检查。
+ * 更新只触及新旧两组单元，矩形未跨出原单元时仅替换矩形本身。
+ */
+template<typename Key, typename Hash = std::hash<Key>>
+class SpatialIndex
+{
+public:
+    explicit SpatialIndex(double cellSize = 256.0)
+        : _cellSize(cellSize)
+    {}
+
+public:
+    /// 插入元素，或更新已存在元素的矩形。
+    void insert(Key const &key, QRectF const &rect)
+    {
+        QRect const cells = cellRange(rect);
+        bool const oversized = isOversized(cells);
+
+        auto it = _entries.find(key);
+
+        if (it != _entries.end()) {
+            Entry &entry = it->second;
+
+            if (entry.cells == cells && entry.oversized == oversized) {
+                entry.rect = rect;
+                return;
+            }
+
+            unregisterEntry(key, entry);
+
+            entry.rect = rect;
+            entry.cells = cells;
+            entry.oversized = oversized;
+
+            registerEntry(key, entry);
+        } else {
+            Entry &entry = _entries[key];
+
+            entry.rect = rect;
+            entry.cells = cells;
+            entry.oversized = oversized;
+
+            registerEntry(key, entry);
+        }
+    }
+
+    /// 移除元素，元素不存在时无操作。
+    void remove(Key const &key)
+    {
+        auto it = _entries.find(key);
+
+        if (it == _entries.end())
+            return;
+
+        unregisterEntry(key, it->second);
+
+        _entries.erase(it);
+    }
+
+    void clear()
+    {
+        _entries.clear();
+        _cells.clear();
+        _oversized.clear();
+    }
+
+    /// 预留元素数量，批量插入前调用以避免反复扩容。
+    void reserve(std::size_t count) { _entries.reserve(count); }
+
+    bool contains(Key const &key) const { return _entries.find(key) != _entries.end(); }
+
+    /// 登记的矩形，元素不存在时返回空矩形。
+    QRectF rect(Key const &key) const
+    {
+        auto it = _entries.find(key);
+
+        return (it != _entries.end()) ? it->second.rect : QRectF();
+    }
+
+    std::size_t size() const { return _entries.size(); }
+
+    /// 所有登记矩形的并集。
+    QRectF boundingRect() const
+    {
+        QRectF result;
+
+        for (auto const &it : _entries)
+            result = result.united(it.second.rect);
+
+        return result;
+    }
+
+    /// 对每个矩形与 `area` 相交的元素调用 `f(key, rect)`，每个元素只调用一次。
+    template<typename F>
+    void forEachIntersecting(QRectF const &area, F f) const
+    {
+        if (_entries.empty())
+            return;
+
+        QRect const range = cellRange(area);
+
+        auto visitCell = [&](int cx, int cy, std::vector<Key> const &keys) {
+            for (Key const &key : keys) {
+                Entry const &entry = _entries.find(key)->second;
+
+                // An entry spanning several cells is reported only from the first
+                // cell it shares with the query range.
+                if (cx != std::max(entry.cells.left(), range.left())
+                    || cy != std::max(entry.cells.top(), range.top()))
+                    continue;
+
+                if (entry.rect.intersects(area))
+                    f(key, entry.rect);
+            }
+        };
+
+        qint64 const rangeCells = qint64(range.width()) * qint64(range.height());
+
+        if (rangeCells > qint64(_cells.size())) {
+            // Zoomed-out queries cover more cells than are populated.
+            for (auto const &cell : _cells) {
+                int const cx = int(cell.first >> 32);
+                int const cy = int(qint32(cell.first & 0xffffffff));
+
+                if (range.contains(cx, cy))
+                    visitCell(cx, cy, cell.second);
+            }
+        } else {
+            for (int cx = range.left(); cx <= range.right(); ++cx) {
+                for (int cy = range.top(); cy <= range.bottom(); ++cy) {
+                    auto it = _cells.find(cellKey(cx, cy));
+
+                    if (it != _cells.end())
+                        visitCell(cx, cy, it->second);
+                }
+            }
+        }
+
+        for (Key const &key : _oversized) {
+            QRectF const &r = _entries.find(key)->second.rect;
+
+            if (r.intersects(area))
+                f(key, r);
+        }
+    }
+
+    /// 矩形与 `area` 相交的元素。
+    std::vector<Key> query(QRectF const &area) const
+    {
+        std::vector<Key> result;
+
+        forEachIntersecting(area, [&result](Key const &key, QRectF const &) {
+            result.push_back(key);
+        });
+
+        return result;
+    }
+
+    /// 矩形包含 `point` 的元素。
+    std::vector<Key> query(QPointF const &point) const
+    {
+        std::vector<Key> result;
+
+        forEachIntersecting(QRectF(point, QSizeF(1e-6, 1e-6)),
+                            [&result, &point](Key const &key, QRectF const &r) {
+                                if (r.contains(point))
+                                    result.push_back(key);
+                            });
+
+        return result;
+    }
+
+private:
+    struct Entry
+    {
+        QRectF rect;
+        QRect cells;
+        bool oversized = false;
+    };
+
+    static constexpr int MaxCellsPerEntry = 64;
+
+    static qint64 cellKey(int cx, int cy)
+    {
+        return (qint64(cx) << 32) | qint64(quint32(cy));
+    }
+
+    QRect cellRange(QRectF const &rect) const
+    {
+        int const left = int(std::floor(rect.left() / _cellSize));
+        int const top = int(std::floor(rect.top() / _cellSize));
+        int const right = int(std::floor(rect.right() / _cellSize));
+        int const bottom = int(std::floor(rect.bottom() / _cellSize));
+
+        return QRect(QPoint(left, top), QPoint(right, bottom));
+    }
+
+    static bool isOversized(QRect const &cells)
+    {
+        return qint64(cells.width()) * qint64(cells.height()) > MaxCellsPerEntry;
+    }
+
+    void registerEntry(Key const &key, Entry const &entry)
+    {
+        if (entry.oversized) {
+            _oversized.push_back(key);
+            return;
+        }
+
+        for (int cx = entry.cells.left(); cx <= entry.cells.right(); ++cx) {
+            for (int cy = entry.cells.top(); cy <= entry.cells.bottom(); ++cy) {
+                _cells[cellKey(cx, cy)].push_back(key);
+            }
+        }
+    }
+
+    void unregisterEntry(Key const &key, Entry const &entry)
+    {
+        auto eraseFrom = [&key](std::vector<Key> &keys) {
+            auto it = std::find(keys.begin(), keys.end(), key);
+
+            if (it != keys.end()) {
+                *it = keys.back();
+                keys.pop_back();
+            }
+        };
+
+        if (entry.oversized) {
+            eraseFrom(_oversized);
+            return;
+        }
+
+        for (int cx = entry.cells.left(); cx <= entry.cells.right(); ++cx) {
+            for (int cy = entry.cells.top(); cy <= entry.cells.bottom(); ++cy) {
+                auto it = _cells.find(cellKey(cx, cy));
+
+                if (it == _cells.end())
+                    continue;
+
+                eraseFrom(it->second);
+
+                if (it->second.empty())
+                    _cells.erase(it);
+            }
+        }
+    }
+
+private:
+    double _cellSize;
+
+    std::unordered_map<Key, Entry, Hash> _entries;
+
+    std::unordered_map<qint64, std::vector<Key>> _cells;
+
+    std::vector<Key> _oversized;
+};
+
+} // namespace QtNodes
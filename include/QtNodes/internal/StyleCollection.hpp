@@ -2,6 +2,8 @@
 
 #include "Export.hpp"
 
+#include <memory>
+
 #include "ConnectionStyle.hpp"
 #include "GraphicsViewStyle.hpp"
 #include "NodeStyle.hpp"
@@ -17,6 +19,17 @@ public:
 
     static GraphicsViewStyle const &flowViewStyle();
 
+    /// Immutable snapshot of the current node style, shared by every node
+    /// that does not define its own one.
+    static std::shared_ptr<NodeStyle const> sharedNodeStyle();
+
+    /// Incremented whenever any node style changes; lets graphics objects
+    /// keep a cached style handle and refresh it only when outdated.
+    static unsigned int nodeStyleVersion();
+
+    /// Marks all cached node styles as outdated.
+    static void invalidateNodeStyles();
+
 public:
     static void setNodeStyle(NodeStyle);
 
@@ -36,6 +49,10 @@ private:
 private:
     NodeStyle _nodeStyle;
 
+    std::shared_ptr<NodeStyle const> _sharedNodeStyle;
+
+    unsigned int _nodeStyleVersion = 0;
+
     ConnectionStyle _connectionStyle;
 
     GraphicsViewStyle _flowViewStyle;
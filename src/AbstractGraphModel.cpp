@@ -2,8 +2,33 @@
 
 #include <QtNodes/ConnectionIdUtils>
 
+#include <QtCore/QJsonDocument>
+
 namespace QtNodes {
 
+std::shared_ptr<NodeStyle const> AbstractGraphModel::nodeStyle(NodeId nodeId) const
+{
+    QJsonDocument json = QJsonDocument::fromVariant(nodeData(nodeId, NodeRole::Style));
+
+    return std::make_shared<NodeStyle const>(json.object());
+}
+
+std::unordered_set<ConnectionId> AbstractGraphModel::allConnections() const
+{
+    std::unordered_set<ConnectionId> result;
+
+    for (NodeId const nodeId : allNodeIds()) {
+        auto const nOutPorts = nodeData(nodeId, NodeRole::OutPortCount).toUInt();
+
+        for (PortIndex index = 0; index < nOutPorts; ++index) {
+            for (ConnectionId const &connectionId : connections(nodeId, PortType::Out, index))
+                result.insert(connectionId);
+        }
+    }
+
+    return result;
+}
+
 void AbstractGraphModel::portsAboutToBeDeleted(NodeId const nodeId,
                                                PortType const portType,
                                                PortIndex const first,
@@ -4,6 +4,7 @@
 #include "StyleCollection.hpp"
 
 #include <QMargins>
+#include <QWidget>
 
 #include <cmath>
 
@@ -74,4 +75,25 @@ PortIndex AbstractNodeGeometry::checkPortHit(NodeId const nodeId,
     return result;
 }
 
+QSize AbstractNodeGeometry::embeddedWidgetSize(NodeId const nodeId, QWidget **widget) const
+{
+    if (widget)
+        *widget = nullptr;
+
+    QSize const hint = _graphModel.nodeData<QSize>(nodeId, NodeRole::WidgetSizeHint);
+
+    if (hint.isValid())
+        return hint;
+
+    auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget);
+
+    if (!w)
+        return QSize();
+
+    if (widget)
+        *widget = w;
+
+    return w->size();
+}
+
 } // namespace QtNodes
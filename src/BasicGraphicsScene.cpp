@@ -1,29 +1,40 @@
 #include "BasicGraphicsScene.hpp"
 
 #include "AbstractNodeGeometry.hpp"
+#include "ConnectionBatchItem.hpp"
 #include "ConnectionGraphicsObject.hpp"
 #include "ConnectionIdUtils.hpp"
+#include "ConnectionRouter.hpp"
 #include "DefaultHorizontalNodeGeometry.hpp"
 #include "DefaultNodePainter.hpp"
 #include "DefaultVerticalNodeGeometry.hpp"
 #include "GraphicsView.hpp"
 #include "NodeGraphicsObject.hpp"
+#include "StyleCollection.hpp"
 
 #include <QUndoStack>
 
 #include <QtWidgets/QFileDialog>
+#include <QtWidgets/QGraphicsSceneMouseEvent>
 #include <QtWidgets/QGraphicsSceneMoveEvent>
+#include <QtWidgets/QWidget>
 
 #include <QtCore/QBuffer>
 #include <QtCore/QByteArray>
 #include <QtCore/QDataStream>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
+#include <QtCore/QTimer>
 #include <QtCore/QtGlobal>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QScreen>
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 #include <unordered_set>
 #include <utility>
@@ -31,6 +42,29 @@
 
 namespace QtNodes {
 
+namespace {
+
+// Time budget of one incremental population step; leaves room for input
+// handling and painting within a few frames.
+qint64 const PopulationSliceMs = 10;
+
+} // namespace
+
+/// Nodes and connections still to be created by the incremental population.
+struct BasicGraphicsScene::Population
+{
+    /// Nearest to the visible area first.
+    std::vector<NodeId> nodes;
+
+    /// Each connection follows the later of its two nodes: it is created
+    /// once that many nodes have been processed.
+    std::vector<std::pair<std::size_t, ConnectionId>> connections;
+
+    std::size_t nextNode = 0;
+
+    std::size_t nextConnection = 0;
+};
+
 BasicGraphicsScene::BasicGraphicsScene(AbstractGraphModel &graphModel, QObject *parent)
     : QGraphicsScene(parent)
     , _graphModel(graphModel)
@@ -39,9 +73,32 @@ BasicGraphicsScene::BasicGraphicsScene(AbstractGraphModel &graphModel, QObject *
     , _nodeDrag(false)
     , _undoStack(new QUndoStack(this))
     , _orientation(Qt::Horizontal)
+    , _levelOfDetail(LevelOfDetail::Full)
+    , _nodeShadowEffectEnabled(false)
+    , _widgetSnapshotsEnabled(false)
+    , _virtualizationEnabled(false)
+    , _connectionBatchingEnabled(false)
+    , _connectionRouting(ConnectionRouting::Curved)
+    , _connectionBundlingEnabled(false)
+    , _contentUpdateTimer(new QTimer(this))
+    , _incrementalPopulationEnabled(false)
+    , _populationSuspended(0)
+    , _populationFromContent(false)
+    , _populationTimer(new QTimer(this))
 {
     setItemIndexMethod(QGraphicsScene::NoIndex);
 
+    _contentUpdateTimer->setSingleShot(true);
+
+    connect(_contentUpdateTimer,
+            &QTimer::timeout,
+            this,
+            &BasicGraphicsScene::flushContentUpdates);
+
+    _populationTimer->setSingleShot(true);
+
+    connect(_populationTimer, &QTimer::timeout, this, &BasicGraphicsScene::populateSlice);
+
     connect(&_graphModel,
             &AbstractGraphModel::connectionCreated,
             this,
@@ -74,12 +131,46 @@ BasicGraphicsScene::BasicGraphicsScene(AbstractGraphModel &graphModel, QObject *
 
     connect(this, &BasicGraphicsScene::nodeClicked, this, &BasicGraphicsScene::onNodeClicked);
 
+    // A node keeps its live widget while the widget has focus.
+    connect(this,
+            &QGraphicsScene::focusItemChanged,
+            this,
+            [this](QGraphicsItem *newFocusItem, QGraphicsItem *oldFocusItem, Qt::FocusReason) {
+                if (!_widgetSnapshotsEnabled)
+                    return;
+
+                for (QGraphicsItem *item : {oldFocusItem, newFocusItem}) {
+                    QGraphicsItem *top = item ? item->topLevelItem() : nullptr;
+
+                    if (auto ngo = qgraphicsitem_cast<NodeGraphicsObject *>(top))
+                        ngo->updateEmbeddedWidgetVisibility();
+                }
+            });
+
     connect(&_graphModel, &AbstractGraphModel::modelReset, this, &BasicGraphicsScene::onModelReset);
 
+    // Queued: selection changes are reported from inside the event handlers
+    // of the very connections that may get demoted.
+    connect(this,
+            &QGraphicsScene::selectionChanged,
+            this,
+            &BasicGraphicsScene::updatePromotedConnections,
+            Qt::QueuedConnection);
+
     traverseGraphAndPopulateGraphicsObjects();
 }
 
-BasicGraphicsScene::~BasicGraphicsScene() = default;
+BasicGraphicsScene::~BasicGraphicsScene()
+{
+    // Objects holding widgets delete them with their proxies; the released
+    // ones have no other owner. Connections go first, as by member order.
+    _draftConnection.reset();
+    _connectionGraphicsObjects.clear();
+    _nodeGraphicsObjects.clear();
+
+    while (!_releasedWidgets.empty())
+        deleteReleasedWidget(_releasedWidgets.begin()->first);
+}
 
 AbstractGraphModel const &BasicGraphicsScene::graphModel() const
 {
@@ -159,23 +250,614 @@ ConnectionGraphicsObject *BasicGraphicsScene::connectionGraphicsObject(Connectio
 
 void BasicGraphicsScene::setOrientation(Qt::Orientation const orientation)
 {
-    if (_orientation != orientation) {
-        _orientation = orientation;
+    if (_orientation == orientation)
+        return;
 
-        switch (_orientation) {
-        case Qt::Horizontal:
-            _nodeGeometry = std::make_unique<DefaultHorizontalNodeGeometry>(_graphModel);
-            break;
+    // Announced while the old geometry still answers boundingRect().
+    for (auto &it : _nodeGraphicsObjects)
+        it.second->setGeometryChanged();
 
-        case Qt::Vertical:
-            _nodeGeometry = std::make_unique<DefaultVerticalNodeGeometry>(_graphModel);
-            break;
+    _orientation = orientation;
+
+    switch (_orientation) {
+    case Qt::Horizontal:
+        _nodeGeometry = std::make_unique<DefaultHorizontalNodeGeometry>(_graphModel);
+        break;
+
+    case Qt::Vertical:
+        _nodeGeometry = std::make_unique<DefaultVerticalNodeGeometry>(_graphModel);
+        break;
+    }
+
+    _nodeGeometry->setFont(font());
+
+    // The existing objects are kept, with their selection and widgets; only
+    // sizes, widget placement and connection paths are recomputed.
+    for (NodeId const nodeId : _graphModel.allNodeIds()) {
+        _nodeGeometry->recomputeSize(nodeId);
+        updateNodeIndex(nodeId);
+
+        if (auto ngo = nodeGraphicsObject(nodeId)) {
+            ngo->updateEmbeddedWidgetGeometry();
+            ngo->update();
         }
+    }
 
-        onModelReset();
+    // Ports moved on every node, so every route changes.
+    invalidateConnectionGeometry();
+
+    // Node rects changed, so the set of nodes near the viewport may have too.
+    updateMaterializedItems();
+
+    // Connection objects cached their old shape; repaint the old areas as well.
+    update();
+}
+
+void BasicGraphicsScene::setLevelOfDetail(LevelOfDetail const lod)
+{
+    if (_levelOfDetail == lod)
+        return;
+
+    _levelOfDetail = lod;
+
+    for (auto &it : _nodeGraphicsObjects) {
+        it.second->applyLevelOfDetail(lod);
+    }
+}
+
+void BasicGraphicsScene::setNodeShadowEffectEnabled(bool enabled)
+{
+    if (_nodeShadowEffectEnabled == enabled)
+        return;
+
+    _nodeShadowEffectEnabled = enabled;
+
+    for (auto &it : _nodeGraphicsObjects) {
+        it.second->applyNodeStyle();
+        it.second->update();
+    }
+}
+
+void BasicGraphicsScene::setWidgetSnapshotsEnabled(bool enabled)
+{
+    if (_widgetSnapshotsEnabled == enabled)
+        return;
+
+    _widgetSnapshotsEnabled = enabled;
+
+    for (auto &it : _nodeGraphicsObjects) {
+        it.second->updateEmbeddedWidgetVisibility();
+    }
+}
+
+QRectF BasicGraphicsScene::nodeSceneRect(NodeId const nodeId) const
+{
+    QPointF const pos = _graphModel.nodeData<QPointF>(nodeId, NodeRole::Position);
+
+    return _nodeGeometry->boundingRect(nodeId).translated(pos);
+}
+
+std::vector<NodeId> BasicGraphicsScene::nodesInRect(QRectF const &sceneRect) const
+{
+    return _nodeIndex.query(sceneRect);
+}
+
+std::vector<NodeId> BasicGraphicsScene::nodesAt(QPointF const &scenePoint) const
+{
+    return _nodeIndex.query(scenePoint);
+}
+
+std::vector<ConnectionId> BasicGraphicsScene::connectionsInRect(QRectF const &sceneRect) const
+{
+    return _connectionIndex.query(sceneRect);
+}
+
+void BasicGraphicsScene::updateNodeIndex(NodeId const nodeId)
+{
+    _nodeIndex.insert(nodeId, nodeSceneRect(nodeId));
+}
+
+void BasicGraphicsScene::updateConnectionIndex(ConnectionId const connectionId,
+                                               QRectF const &sceneRect)
+{
+    _connectionIndex.insert(connectionId, sceneRect);
+}
+
+void BasicGraphicsScene::setVirtualizationEnabled(bool enabled)
+{
+    if (_virtualizationEnabled == enabled)
+        return;
+
+    _virtualizationEnabled = enabled;
+
+    onModelReset();
+}
+
+void BasicGraphicsScene::setVisibleSceneRect(QRectF const &sceneRect)
+{
+    _visibleSceneRect = sceneRect;
+
+    updateMaterializedItems();
+
+    // Creates deferred widgets of nodes scrolled into view.
+    if (_levelOfDetail == LevelOfDetail::Full) {
+        for (NodeId const nodeId : nodesInRect(_visibleSceneRect)) {
+            if (auto ngo = nodeGraphicsObject(nodeId))
+                ngo->updateEmbeddedWidgetVisibility();
+        }
+    }
+}
+
+QPointF BasicGraphicsScene::portScenePosition(NodeId const nodeId,
+                                              PortType const portType,
+                                              PortIndex const portIndex) const
+{
+    QTransform nodeTransform;
+
+    auto it = _nodeGraphicsObjects.find(nodeId);
+    if (it != _nodeGraphicsObjects.end()) {
+        nodeTransform = it->second->sceneTransform();
+    } else {
+        QPointF const pos = _graphModel.nodeData<QPointF>(nodeId, NodeRole::Position);
+        nodeTransform.translate(pos.x(), pos.y());
+    }
+
+    return _nodeGeometry->portScenePosition(nodeId, portType, portIndex, nodeTransform);
+}
+
+QRectF BasicGraphicsScene::connectionSceneRect(ConnectionId const connectionId) const
+{
+    QPointF const out = portScenePosition(connectionId.outNodeId,
+                                          PortType::Out,
+                                          connectionId.outPortIndex);
+    QPointF const in = portScenePosition(connectionId.inNodeId,
+                                         PortType::In,
+                                         connectionId.inPortIndex);
+
+    QRectF rect;
+
+    // Bounds the route without computing it.
+    if (_connectionRouter) {
+        rect = _connectionRouter->routingArea(connectionId);
+    } else {
+        auto const c1c2 = ConnectionGraphicsObject::pointsC1C2(out, in, _orientation);
+
+        rect = QRectF(out, in).normalized().united(QRectF(c1c2.first, c1c2.second).normalized());
+    }
+
+    // Same margins as ConnectionGraphicsObject::boundingRect.
+    double const diam = StyleCollection::connectionStyle().pointDiameter();
+
+    return rect.adjusted(-diam, -diam, 2 * diam, 2 * diam);
+}
+
+void BasicGraphicsScene::scheduleConnectionUpdate(NodeId const nodeId)
+{
+    bool const first = _connectionUpdateNodes.empty() && _routeUpdateConnections.empty();
+
+    _connectionUpdateNodes.insert(nodeId);
+
+    // Runs before the viewport's update request is handled: the repaints
+    // requested by the flush go through the scene's queued dirty item
+    // processing and merge into the same pending viewport update. Flushing
+    // from paintEvent instead would move items while the view paints.
+    if (first)
+        QMetaObject::invokeMethod(
+            this, [this]() { flushConnectionUpdates(); }, Qt::QueuedConnection);
+}
+
+void BasicGraphicsScene::scheduleRouteUpdate(QRectF const &sceneRect)
+{
+    if (!_connectionRouter || sceneRect.isEmpty())
+        return;
+
+    bool const first = _connectionUpdateNodes.empty() && _routeUpdateConnections.empty();
+
+    for (ConnectionId const &connectionId : _connectionIndex.query(sceneRect))
+        _routeUpdateConnections.insert(connectionId);
+
+    if (first && !_routeUpdateConnections.empty())
+        QMetaObject::invokeMethod(
+            this, [this]() { flushConnectionUpdates(); }, Qt::QueuedConnection);
+}
+
+void BasicGraphicsScene::flushConnectionUpdates()
+{
+    if (_connectionUpdateNodes.empty() && _routeUpdateConnections.empty())
+        return;
+
+    std::unordered_set<NodeId> nodes;
+    nodes.swap(_connectionUpdateNodes);
+
+    // A connection between two moved nodes is recomputed once.
+    std::unordered_set<ConnectionId> connections;
+    connections.swap(_routeUpdateConnections);
+
+    for (NodeId const nodeId : nodes) {
+        if (!_graphModel.nodeExists(nodeId))
+            continue;
+
+        for (ConnectionId const &connectionId : _graphModel.allConnectionIds(nodeId))
+            connections.insert(connectionId);
+    }
+
+    for (ConnectionId const &connectionId : connections) {
+        if (_connectionRouter) {
+            if (!_graphModel.connectionExists(connectionId))
+                continue;
+
+            _connectionRouter->invalidate(connectionId);
+        }
+
+        if (auto cgo = connectionGraphicsObject(connectionId)) {
+            cgo->move();
+
+            // The route also changes when only a node along the way moved.
+            if (_connectionRouter)
+                cgo->invalidateGeometry();
+        } else {
+            updateDetachedConnection(connectionId);
+        }
+    }
+}
+
+void BasicGraphicsScene::updateDetachedConnection(ConnectionId const connectionId)
+{
+    if (!_virtualizationEnabled && !_connectionBatch)
+        return;
+
+    QRectF const oldRect = _connectionIndex.rect(connectionId);
+    QRectF const newRect = connectionSceneRect(connectionId);
+
+    updateConnectionIndex(connectionId, newRect);
+
+    if (_connectionBatch)
+        _connectionBatch->invalidate(connectionId, oldRect.united(newRect));
+}
+
+void BasicGraphicsScene::invalidateConnectionGeometry()
+{
+    if (_connectionRouter)
+        _connectionRouter->invalidateAll();
+
+    for (ConnectionId const &connectionId : _graphModel.allConnections()) {
+        if (auto cgo = connectionGraphicsObject(connectionId)) {
+            cgo->move();
+            cgo->invalidateGeometry();
+        } else if (_virtualizationEnabled || _connectionBatch) {
+            updateConnectionIndex(connectionId, connectionSceneRect(connectionId));
+        }
+    }
+
+    if (_draftConnection)
+        _draftConnection->move();
+
+    if (_connectionBatch)
+        _connectionBatch->invalidateAll();
+}
+
+void BasicGraphicsScene::setConnectionBatchingEnabled(bool enabled)
+{
+    if (_connectionBatchingEnabled == enabled)
+        return;
+
+    _connectionBatchingEnabled = enabled;
+
+    onModelReset();
+}
+
+ConnectionGraphicsObject *BasicGraphicsScene::materializeConnection(
+    ConnectionId const connectionId)
+{
+    auto it = _connectionGraphicsObjects.find(connectionId);
+    if (it != _connectionGraphicsObjects.end())
+        return it->second.get();
+
+    if (!_graphModel.connectionExists(connectionId))
+        return nullptr;
+
+    auto cgo = std::make_unique<ConnectionGraphicsObject>(*this, connectionId);
+    ConnectionGraphicsObject *result = cgo.get();
+
+    QRectF const rect = cgo->sceneBoundingRect();
+    updateConnectionIndex(connectionId, rect);
+
+    _connectionGraphicsObjects[connectionId] = std::move(cgo);
+
+    // Erase the batched copy underneath.
+    if (_connectionBatch)
+        _connectionBatch->update(rect);
+
+    return result;
+}
+
+bool BasicGraphicsScene::batchedConnectionIntersects(ConnectionId const connectionId,
+                                                     QPainterPath const &sceneArea) const
+{
+    return _connectionBatch && _connectionBatch->connectionIntersects(connectionId, sceneArea);
+}
+
+void BasicGraphicsScene::setConnectionRouting(ConnectionRouting const routing)
+{
+    if (_connectionRouting == routing)
+        return;
+
+    _connectionRouting = routing;
+
+    _connectionRouter.reset();
+
+    if (_connectionRouting == ConnectionRouting::Orthogonal) {
+        _connectionRouter = std::make_unique<ConnectionRouter>(*this);
+        _connectionRouter->setBundlingEnabled(_connectionBundlingEnabled);
+    }
+
+    // Routed connections cover more of the scene than curves, and the other
+    // way round, so the materialized set follows the new index rects.
+    invalidateConnectionGeometry();
+
+    updateMaterializedItems();
+
+    update();
+}
+
+void BasicGraphicsScene::setConnectionBundlingEnabled(bool enabled)
+{
+    if (_connectionBundlingEnabled == enabled)
+        return;
+
+    _connectionBundlingEnabled = enabled;
+
+    if (!_connectionRouter)
+        return;
+
+    _connectionRouter->setBundlingEnabled(enabled);
+
+    invalidateConnectionGeometry();
+
+    updateMaterializedItems();
+
+    update();
+}
+
+QPainterPath BasicGraphicsScene::connectionRoute(ConnectionId const connectionId) const
+{
+    if (!_connectionRouter)
+        return QPainterPath();
+
+    return _connectionRouter->route(connectionId);
+}
+
+void BasicGraphicsScene::updatePromotedConnections()
+{
+    if (!_connectionBatch)
+        return;
+
+    QGraphicsItem *const grabber = mouseGrabberItem();
+
+    for (auto it = _connectionGraphicsObjects.begin(); it != _connectionGraphicsObjects.end();) {
+        ConnectionGraphicsObject *cgo = it->second.get();
+
+        bool const pinned = cgo->isSelected() || cgo->connectionState().hovered()
+                            || grabber == cgo
+                            || cgo->shape().contains(cgo->mapFromScene(_lastHoverScenePos));
+
+        if (pinned) {
+            ++it;
+            continue;
+        }
+
+        ConnectionId const connectionId = it->first;
+        QRectF const rect = cgo->sceneBoundingRect();
+
+        it = _connectionGraphicsObjects.erase(it);
+
+        // The cached curve may predate node moves made while promoted.
+        _connectionBatch->invalidate(connectionId, rect);
     }
 }
 
+bool BasicGraphicsScene::event(QEvent *event)
+{
+    if (event->type() == QEvent::FontChange) {
+        _nodeGeometry->setFont(font());
+
+        for (NodeId const nodeId : _graphModel.allNodeIds()) {
+            auto ngo = nodeGraphicsObject(nodeId);
+
+            if (ngo)
+                ngo->setGeometryChanged();
+
+            _nodeGeometry->recomputeSize(nodeId);
+            updateNodeIndex(nodeId);
+
+            if (ngo)
+                ngo->update();
+
+            scheduleConnectionUpdate(nodeId);
+        }
+    }
+
+    return QGraphicsScene::event(event);
+}
+
+void BasicGraphicsScene::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
+{
+    QGraphicsScene::mouseMoveEvent(event);
+
+    if (!_connectionBatch || event->buttons() != Qt::NoButton || mouseGrabberItem())
+        return;
+
+    _lastHoverScenePos = event->scenePos();
+
+    updatePromotedConnections();
+
+    // The new object receives its hover enter event with the next move.
+    ConnectionId connectionId;
+    if (_connectionBatch->connectionAt(_lastHoverScenePos, connectionId))
+        materializeConnection(connectionId);
+}
+
+void BasicGraphicsScene::updateMaterializedItems()
+{
+    if (!_virtualizationEnabled || _visibleSceneRect.isEmpty())
+        return;
+
+    double const margin = 0.5 * std::max(_visibleSceneRect.width(), _visibleSceneRect.height());
+
+    QRectF const area = _visibleSceneRect.adjusted(-margin, -margin, margin, margin);
+
+    QGraphicsItem *const grabber = mouseGrabberItem();
+    QGraphicsItem *const focused = focusItem();
+
+    // Nodes
+    std::unordered_set<NodeId> wantedNodes;
+    for (NodeId const nodeId : _nodeIndex.query(area))
+        wantedNodes.insert(nodeId);
+
+    std::vector<NodeId> releasedNodes;
+    for (auto const &it : _nodeGraphicsObjects) {
+        NodeGraphicsObject *ngo = it.second.get();
+
+        if (wantedNodes.count(it.first))
+            continue;
+
+        bool const pinned = ngo->isSelected() || ngo->nodeState().hovered() || grabber == ngo
+                            || (focused && (focused == ngo || ngo->isAncestorOf(focused)));
+
+        if (!pinned)
+            releasedNodes.push_back(it.first);
+    }
+
+    for (NodeId const nodeId : releasedNodes)
+        releaseNode(nodeId);
+
+    for (NodeId const nodeId : wantedNodes) {
+        if (_nodeGraphicsObjects.find(nodeId) == _nodeGraphicsObjects.end())
+            materializeNode(nodeId);
+    }
+
+    // Batched connections are drawn by the batch layer and promoted on demand.
+    if (_connectionBatch)
+        return;
+
+    // Connections crossing the area are shown even when both ends are outside.
+    std::unordered_set<ConnectionId> wantedConnections;
+    for (ConnectionId const &connectionId : _connectionIndex.query(area))
+        wantedConnections.insert(connectionId);
+
+    for (auto it = _connectionGraphicsObjects.begin(); it != _connectionGraphicsObjects.end();) {
+        ConnectionGraphicsObject *cgo = it->second.get();
+
+        bool const pinned = cgo->isSelected() || cgo->connectionState().hovered()
+                            || grabber == cgo;
+
+        if (!wantedConnections.count(it->first) && !pinned) {
+            it = _connectionGraphicsObjects.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (ConnectionId const &connectionId : wantedConnections) {
+        if (_connectionGraphicsObjects.find(connectionId) == _connectionGraphicsObjects.end()) {
+            _connectionGraphicsObjects[connectionId]
+                = std::make_unique<ConnectionGraphicsObject>(*this, connectionId);
+        }
+    }
+}
+
+void BasicGraphicsScene::materializeNode(NodeId const nodeId)
+{
+    UniqueNodeGraphicsObject ngo;
+
+    if (!_nodeGraphicsObjectPool.empty()) {
+        ngo = std::move(_nodeGraphicsObjectPool.back());
+        _nodeGraphicsObjectPool.pop_back();
+
+        ngo->setNodeId(nodeId);
+        ngo->show();
+    } else {
+        ngo = std::make_unique<NodeGraphicsObject>(*this, nodeId);
+    }
+
+    _nodeGraphicsObjects[nodeId] = std::move(ngo);
+}
+
+void BasicGraphicsScene::releaseNode(NodeId const nodeId)
+{
+    auto it = _nodeGraphicsObjects.find(nodeId);
+    if (it == _nodeGraphicsObjects.end())
+        return;
+
+    // Recycled objects start at the default z-value.
+    lowerNode(nodeId);
+
+    UniqueNodeGraphicsObject ngo = std::move(it->second);
+    _nodeGraphicsObjects.erase(it);
+
+    // The node is still in the model, so its widget must survive the object.
+    if (QWidget *w = ngo->releaseEmbeddedWidget())
+        _releasedWidgets[nodeId] = w;
+
+    std::size_t const maxPoolSize = 256;
+
+    if (_nodeGraphicsObjectPool.size() < maxPoolSize) {
+        ngo->hide();
+        ngo->setNodeId(InvalidNodeId);
+
+        _nodeGraphicsObjectPool.push_back(std::move(ngo));
+    }
+}
+
+void BasicGraphicsScene::deleteReleasedWidget(NodeId const nodeId)
+{
+    auto it = _releasedWidgets.find(nodeId);
+
+    if (it == _releasedWidgets.end())
+        return;
+
+    QPointer<QWidget> const w = it->second;
+    _releasedWidgets.erase(it);
+
+    // Embedded again since, or deleted by its delegate.
+    if (w && !w->graphicsProxyWidget())
+        delete w.data();
+}
+
+void BasicGraphicsScene::raiseNode(NodeId const nodeId, bool const lowerOthers)
+{
+    if (lowerOthers) {
+        for (NodeId const raised : _raisedNodes) {
+            if (raised == nodeId)
+                continue;
+
+            if (auto ngo = nodeGraphicsObject(raised))
+                ngo->setZValue(0.0);
+        }
+
+        _raisedNodes.clear();
+    }
+
+    if (std::find(_raisedNodes.begin(), _raisedNodes.end(), nodeId) == _raisedNodes.end())
+        _raisedNodes.push_back(nodeId);
+
+    if (auto ngo = nodeGraphicsObject(nodeId))
+        ngo->setZValue(1.0);
+}
+
+void BasicGraphicsScene::lowerNode(NodeId const nodeId)
+{
+    auto it = std::find(_raisedNodes.begin(), _raisedNodes.end(), nodeId);
+
+    if (it == _raisedNodes.end())
+        return;
+
+    _raisedNodes.erase(it);
+
+    if (auto ngo = nodeGraphicsObject(nodeId))
+        ngo->setZValue(0.0);
+}
+
 QMenu *BasicGraphicsScene::createSceneMenu(QPointF const scenePos)
 {
     Q_UNUSED(scenePos);
@@ -184,26 +866,230 @@ QMenu *BasicGraphicsScene::createSceneMenu(QPointF const scenePos)
 
 void BasicGraphicsScene::traverseGraphAndPopulateGraphicsObjects()
 {
+    // The scene is populated once the model changes are done.
+    if (_populationSuspended > 0)
+        return;
+
     auto allNodeIds = _graphModel.allNodeIds();
 
-    // First create all the nodes.
-    for (NodeId const nodeId : allNodeIds) {
-        _nodeGraphicsObjects[nodeId] = std::make_unique<NodeGraphicsObject>(*this, nodeId);
+    // One pass over the model's connections instead of a query per out port.
+    auto allConnections = _graphModel.allConnections();
+
+    _nodeIndex.reserve(allNodeIds.size());
+    _connectionIndex.reserve(allConnections.size());
+
+    if (_incrementalPopulationEnabled) {
+        startPopulation(allNodeIds, allConnections);
+        return;
     }
 
-    // Then for each node check output connections and insert them.
-    for (NodeId const nodeId : allNodeIds) {
-        auto nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+    if (!_virtualizationEnabled) {
+        _nodeGraphicsObjects.reserve(allNodeIds.size());
+
+        if (!_connectionBatch)
+            _connectionGraphicsObjects.reserve(allConnections.size());
+    }
+
+    // First create all the nodes, then the connections between them.
+    for (NodeId const nodeId : allNodeIds)
+        populateNode(nodeId);
+
+    for (ConnectionId const &cid : allConnections)
+        populateConnection(cid);
+
+    // Virtualized scenes only indexed the graph; objects are created for the visible area.
+    updateMaterializedItems();
+
+    if (_connectionBatch)
+        _connectionBatch->invalidateAll();
+
+    Q_EMIT populationFinished();
+}
+
+void BasicGraphicsScene::startPopulation(std::unordered_set<NodeId> const &nodeIds,
+                                         std::unordered_set<ConnectionId> const &connectionIds)
+{
+    std::vector<std::pair<QPointF, NodeId>> positions;
+    positions.reserve(nodeIds.size());
+
+    // Zero-sized rects do not unite, so the bounds are tracked by hand.
+    QPointF topLeft(std::numeric_limits<qreal>::max(), std::numeric_limits<qreal>::max());
+    QPointF bottomRight(std::numeric_limits<qreal>::lowest(),
+                        std::numeric_limits<qreal>::lowest());
+
+    for (NodeId const nodeId : nodeIds) {
+        QPointF const pos = _graphModel.nodeData<QPointF>(nodeId, NodeRole::Position);
+
+        positions.emplace_back(pos, nodeId);
+
+        topLeft = QPointF(qMin(topLeft.x(), pos.x()), qMin(topLeft.y(), pos.y()));
+        bottomRight = QPointF(qMax(bottomRight.x(), pos.x()), qMax(bottomRight.y(), pos.y()));
+    }
+
+    QRectF const bounds = positions.empty() ? QRectF() : QRectF(topLeft, bottomRight);
+
+    // After a bulk change such as a file load the viewport still shows the
+    // old contents and views usually move to the new ones; a viewport away
+    // from the graph says nothing about what will be visible either.
+    QPointF center = bounds.center();
+
+    if (!_populationFromContent && !_visibleSceneRect.isEmpty()
+        && bounds.adjusted(-1, -1, 1, 1).contains(_visibleSceneRect.center()))
+        center = _visibleSceneRect.center();
+
+    _populationFromContent = false;
+
+    std::vector<std::pair<qreal, NodeId>> nodesByDistance;
+    nodesByDistance.reserve(positions.size());
+
+    for (auto const &position : positions) {
+        QPointF const d = position.first - center;
+
+        nodesByDistance.emplace_back(QPointF::dotProduct(d, d), position.second);
+    }
 
-        for (PortIndex index = 0; index < nOutPorts; ++index) {
-            auto const &outConnectionIds = _graphModel.connections(nodeId, PortType::Out, index);
+    std::sort(nodesByDistance.begin(), nodesByDistance.end());
 
-            for (auto cid : outConnectionIds) {
-                _connectionGraphicsObjects[cid] = std::make_unique<ConnectionGraphicsObject>(*this,
-                                                                                             cid);
-            }
+    auto population = std::make_unique<Population>();
+    population->nodes.reserve(nodesByDistance.size());
+
+    std::unordered_map<NodeId, std::size_t> rank;
+    rank.reserve(nodesByDistance.size());
+
+    for (auto const &node : nodesByDistance) {
+        rank[node.second] = population->nodes.size();
+        population->nodes.push_back(node.second);
+    }
+
+    population->connections.reserve(connectionIds.size());
+
+    for (ConnectionId const &cid : connectionIds) {
+        auto const out = rank.find(cid.outNodeId);
+        auto const in = rank.find(cid.inNodeId);
+
+        std::size_t const after = (out != rank.end() && in != rank.end())
+                                      ? std::max(out->second, in->second) + 1
+                                      : population->nodes.size();
+
+        population->connections.emplace_back(after, cid);
+    }
+
+    std::sort(population->connections.begin(),
+              population->connections.end(),
+              [](std::pair<std::size_t, ConnectionId> const &a,
+                 std::pair<std::size_t, ConnectionId> const &b) { return a.first < b.first; });
+
+    _population = std::move(population);
+
+    // The first slice runs right away so that the visible area fills without a delay.
+    populateSlice();
+}
+
+void BasicGraphicsScene::populateSlice()
+{
+    if (!_population)
+        return;
+
+    Population &p = *_population;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Items deleted or already created through the model signals meanwhile are skipped.
+    while (timer.elapsed() < PopulationSliceMs) {
+        if (p.nextConnection < p.connections.size()
+            && p.connections[p.nextConnection].first <= p.nextNode) {
+            ConnectionId const cid = p.connections[p.nextConnection++].second;
+
+            if (_graphModel.connectionExists(cid)
+                && _connectionGraphicsObjects.find(cid) == _connectionGraphicsObjects.end())
+                populateConnection(cid);
+        } else if (p.nextNode < p.nodes.size()) {
+            NodeId const nodeId = p.nodes[p.nextNode++];
+
+            if (_graphModel.nodeExists(nodeId)
+                && _nodeGraphicsObjects.find(nodeId) == _nodeGraphicsObjects.end())
+                populateNode(nodeId);
+        } else {
+            break;
         }
     }
+
+    updateMaterializedItems();
+
+    if (_connectionBatch)
+        _connectionBatch->invalidateAll();
+
+    std::size_t const total = p.nodes.size() + p.connections.size();
+    std::size_t const done = p.nextNode + p.nextConnection;
+
+    Q_EMIT populationProgress(static_cast<int>(done), static_cast<int>(total));
+
+    if (done < total) {
+        _populationTimer->start(0);
+        return;
+    }
+
+    _population.reset();
+
+    Q_EMIT populationFinished();
+}
+
+void BasicGraphicsScene::populateNode(NodeId const nodeId)
+{
+    if (_virtualizationEnabled) {
+        _nodeGeometry->recomputeSize(nodeId);
+        updateNodeIndex(nodeId);
+        return;
+    }
+
+    _nodeGraphicsObjects[nodeId] = std::make_unique<NodeGraphicsObject>(*this, nodeId);
+    updateNodeIndex(nodeId);
+}
+
+void BasicGraphicsScene::populateConnection(ConnectionId const connectionId)
+{
+    if (_virtualizationEnabled || _connectionBatch) {
+        updateConnectionIndex(connectionId, connectionSceneRect(connectionId));
+        return;
+    }
+
+    auto cgo = std::make_unique<ConnectionGraphicsObject>(*this, connectionId);
+    updateConnectionIndex(connectionId, cgo->sceneBoundingRect());
+    _connectionGraphicsObjects[connectionId] = std::move(cgo);
+}
+
+void BasicGraphicsScene::setIncrementalPopulationEnabled(bool enabled)
+{
+    _incrementalPopulationEnabled = enabled;
+}
+
+void BasicGraphicsScene::suspendPopulation()
+{
+    if (_populationSuspended++ == 0)
+        cancelPopulation();
+}
+
+void BasicGraphicsScene::resumePopulation()
+{
+    Q_ASSERT(_populationSuspended > 0);
+
+    if (--_populationSuspended == 0) {
+        _populationFromContent = true;
+        onModelReset();
+        _populationFromContent = false;
+    }
+}
+
+void BasicGraphicsScene::cancelPopulation()
+{
+    if (!_population)
+        return;
+
+    _populationTimer->stop();
+    _population.reset();
+
+    Q_EMIT populationCanceled();
 }
 
 void BasicGraphicsScene::updateAttachedNodes(ConnectionId const connectionId,
@@ -223,6 +1109,18 @@ void BasicGraphicsScene::onConnectionDeleted(ConnectionId const connectionId)
         _connectionGraphicsObjects.erase(it);
     }
 
+    QRectF const indexedRect = _connectionIndex.rect(connectionId);
+
+    _connectionIndex.remove(connectionId);
+
+    if (_connectionRouter) {
+        _connectionRouter->invalidate(connectionId);
+        _routeUpdateConnections.erase(connectionId);
+    }
+
+    if (_connectionBatch)
+        _connectionBatch->invalidate(connectionId, indexedRect);
+
     // TODO: do we need it?
     if (_draftConnection && _draftConnection->connectionId() == connectionId) {
         _draftConnection.reset();
@@ -236,8 +1134,19 @@ void BasicGraphicsScene::onConnectionDeleted(ConnectionId const connectionId)
 
 void BasicGraphicsScene::onConnectionCreated(ConnectionId const connectionId)
 {
-    _connectionGraphicsObjects[connectionId]
-        = std::make_unique<ConnectionGraphicsObject>(*this, connectionId);
+    // Created with the rest of the scene by resumePopulation().
+    if (_populationSuspended > 0)
+        return;
+
+    if (_connectionBatch) {
+        QRectF const rect = connectionSceneRect(connectionId);
+        updateConnectionIndex(connectionId, rect);
+        _connectionBatch->invalidate(connectionId, rect);
+    } else {
+        auto cgo = std::make_unique<ConnectionGraphicsObject>(*this, connectionId);
+        updateConnectionIndex(connectionId, cgo->sceneBoundingRect());
+        _connectionGraphicsObjects[connectionId] = std::move(cgo);
+    }
 
     updateAttachedNodes(connectionId, PortType::Out);
     updateAttachedNodes(connectionId, PortType::In);
@@ -247,42 +1156,128 @@ void BasicGraphicsScene::onConnectionCreated(ConnectionId const connectionId)
 
 void BasicGraphicsScene::onNodeDeleted(NodeId const nodeId)
 {
+    lowerNode(nodeId);
+
+    // Routes around the node may now take a shorter way.
+    scheduleRouteUpdate(_nodeIndex.rect(nodeId));
+
+    _nodeIndex.remove(nodeId);
+    _nodeGeometry->invalidateCache(nodeId);
+
     auto it = _nodeGraphicsObjects.find(nodeId);
     if (it != _nodeGraphicsObjects.end()) {
         _nodeGraphicsObjects.erase(it);
 
         Q_EMIT modified(this);
     }
+
+    deleteReleasedWidget(nodeId);
 }
 
 void BasicGraphicsScene::onNodeCreated(NodeId const nodeId)
 {
+    if (_populationSuspended > 0)
+        return;
+
     _nodeGraphicsObjects[nodeId] = std::make_unique<NodeGraphicsObject>(*this, nodeId);
+    updateNodeIndex(nodeId);
+
+    scheduleRouteUpdate(_nodeIndex.rect(nodeId));
 
     Q_EMIT modified(this);
 }
 
 void BasicGraphicsScene::onNodePositionUpdated(NodeId const nodeId)
 {
+    // Nodes added while population is suspended are placed by resumePopulation().
+    if (_populationSuspended > 0 && !_nodeIndex.contains(nodeId))
+        return;
+
+    // Routes past the old and the new place of the node.
+    scheduleRouteUpdate(_nodeIndex.rect(nodeId));
+
+    updateNodeIndex(nodeId);
+    scheduleConnectionUpdate(nodeId);
+
+    scheduleRouteUpdate(_nodeIndex.rect(nodeId));
+
     auto node = nodeGraphicsObject(nodeId);
     if (node) {
         node->setPos(_graphModel.nodeData(nodeId, NodeRole::Position).value<QPointF>());
         node->update();
         _nodeDrag = true;
+    } else if (_virtualizationEnabled && _nodeIndex.rect(nodeId).intersects(_visibleSceneRect)) {
+        // Moved into view programmatically, e.g. by undo.
+        materializeNode(nodeId);
     }
 }
 
 void BasicGraphicsScene::onNodeUpdated(NodeId const nodeId)
 {
+    scheduleRouteUpdate(_nodeIndex.rect(nodeId));
+
     auto node = nodeGraphicsObject(nodeId);
 
     if (node) {
+        node->invalidateNodeStyle();
+        node->invalidateWidgetSnapshot();
+
         node->setGeometryChanged();
 
         _nodeGeometry->recomputeSize(nodeId);
+        updateNodeIndex(nodeId);
+
+        // The layout above already accounts for the current widget size.
+        node->embeddedWidgetResized();
 
         node->update();
-        node->moveConnections();
+    } else if (_virtualizationEnabled) {
+        _nodeGeometry->recomputeSize(nodeId);
+        updateNodeIndex(nodeId);
+    } else {
+        _nodeGeometry->invalidateCache(nodeId);
+    }
+
+    scheduleConnectionUpdate(nodeId);
+
+    scheduleRouteUpdate(_nodeIndex.rect(nodeId));
+}
+
+void BasicGraphicsScene::onNodeContentUpdated(NodeId const nodeId)
+{
+    _contentUpdateNodes.insert(nodeId);
+
+    if (_contentUpdateTimer->isActive())
+        return;
+
+    // One repaint per display frame, however often the data changes.
+    qreal refreshRate = 60.0;
+
+    if (QScreen const *screen = QGuiApplication::primaryScreen())
+        refreshRate = qMax<qreal>(screen->refreshRate(), 1.0);
+
+    _contentUpdateTimer->start(qRound(1000.0 / refreshRate));
+}
+
+void BasicGraphicsScene::flushContentUpdates()
+{
+    std::unordered_set<NodeId> nodes;
+    nodes.swap(_contentUpdateNodes);
+
+    for (NodeId const nodeId : nodes) {
+        auto node = nodeGraphicsObject(nodeId);
+
+        if (!node)
+            continue;
+
+        // Widgets resize themselves when showing new data; only then the
+        // node needs a new layout.
+        node->invalidateWidgetSnapshot();
+
+        if (node->embeddedWidgetResized())
+            onNodeUpdated(nodeId);
+        else
+            node->update();
     }
 }
 
@@ -297,11 +1292,43 @@ void BasicGraphicsScene::onNodeClicked(NodeId const nodeId)
 
 void BasicGraphicsScene::onModelReset()
 {
+    cancelPopulation();
+
+    _connectionBatch.reset();
     _connectionGraphicsObjects.clear();
     _nodeGraphicsObjects.clear();
+    _nodeGraphicsObjectPool.clear();
+    _connectionUpdateNodes.clear();
+    _routeUpdateConnections.clear();
+    _contentUpdateNodes.clear();
+    _raisedNodes.clear();
+
+    _connectionIndex.clear();
+    _nodeIndex.clear();
+
+    // Widgets of nodes that survived the reset are embedded again below.
+    std::vector<NodeId> goneNodes;
+
+    for (auto const &it : _releasedWidgets) {
+        if (!_graphModel.nodeExists(it.first))
+            goneNodes.push_back(it.first);
+    }
+
+    for (NodeId const nodeId : goneNodes)
+        deleteReleasedWidget(nodeId);
 
     clear();
 
+    if (_connectionBatchingEnabled)
+        _connectionBatch = std::make_unique<ConnectionBatchItem>(*this);
+
+    _connectionRouter.reset();
+
+    if (_connectionRouting == ConnectionRouting::Orthogonal) {
+        _connectionRouter = std::make_unique<ConnectionRouter>(*this);
+        _connectionRouter->setBundlingEnabled(_connectionBundlingEnabled);
+    }
+
     traverseGraphAndPopulateGraphicsObjects();
 }
 
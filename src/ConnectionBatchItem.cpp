@@ -0,0 +1,262 @@
+#include "ConnectionBatchItem.hpp"
+
+#include "AbstractGraphModel.hpp"
+#include "BasicGraphicsScene.hpp"
+#include "ConnectionPainter.hpp"
+#include "ConnectionStyle.hpp"
+#include "NodeData.hpp"
+#include "PaintCounters.hpp"
+#include "StyleCollection.hpp"
+
+#include <QtGui/QPainter>
+#include <QtWidgets/QStyleOptionGraphicsItem>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace QtNodes {
+
+ConnectionBatchItem::ConnectionBatchItem(BasicGraphicsScene &scene)
+    : _scene(scene)
+{
+    // Needed for a meaningful exposedRect in paint().
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+
+    setAcceptedMouseButtons(Qt::NoButton);
+    setAcceptHoverEvents(false);
+
+    // Same layer as ConnectionGraphicsObject; promoted connections are added
+    // later and therefore stack on top.
+    setZValue(-1.0);
+
+    scene.addItem(this);
+}
+
+QRectF ConnectionBatchItem::boundingRect() const
+{
+    return _bounds;
+}
+
+QPainterPath ConnectionBatchItem::shape() const
+{
+    // Keeps the item out of itemAt() and the default hover dispatch.
+    return QPainterPath();
+}
+
+void ConnectionBatchItem::paint(QPainter *painter,
+                                QStyleOptionGraphicsItem const *option,
+                                QWidget *)
+{
+    double const scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform());
+
+    LevelOfDetail const lod = StyleCollection::flowViewStyle().levelOfDetail(scale);
+
+    auto const &connectionStyle = StyleCollection::connectionStyle();
+
+    std::vector<std::pair<QColor, QPainterPath>> batches;
+    std::vector<Entry> conversions;
+    QPainterPath endPoints;
+
+    quint64 painted = 0;
+
+    double const pointRadius = connectionStyle.pointDiameter() / 2.0;
+
+    // QGraphicsScene::render() exposes the whole item; its clip is the
+    // rendered area.
+    QRectF exposed = option->exposedRect;
+
+    if (painter->hasClipping())
+        exposed &= painter->clipBoundingRect();
+
+    _scene.connectionIndex().forEachIntersecting(
+        exposed, [&](ConnectionId const &connectionId, QRectF const &) {
+            // Promoted connections paint themselves.
+            if (_scene.connectionGraphicsObject(connectionId))
+                return;
+
+            Entry const &e = entry(connectionId);
+
+            ++painted;
+
+            if (lod == LevelOfDetail::Full) {
+                endPoints.addEllipse(e.out, pointRadius, pointRadius);
+                endPoints.addEllipse(e.in, pointRadius, pointRadius);
+
+                if (e.conversion) {
+                    conversions.push_back(e);
+                    return;
+                }
+            }
+
+            auto batch = std::find_if(batches.begin(),
+                                      batches.end(),
+                                      [&e](std::pair<QColor, QPainterPath> const &b) {
+                                          return b.first == e.color;
+                                      });
+
+            if (batch == batches.end()) {
+                batches.emplace_back(e.color, QPainterPath());
+                batch = std::prev(batches.end());
+            }
+
+            if (lod == LevelOfDetail::Minimal) {
+                batch->second.moveTo(e.out);
+                batch->second.lineTo(e.in);
+            } else {
+                batch->second.addPath(e.path);
+            }
+        });
+
+    PaintCounters::add(PaintCounters::ConnectionPaints, painted);
+
+    painter->setBrush(Qt::NoBrush);
+
+    for (auto const &batch : batches) {
+        QPen p(batch.first);
+
+        if (lod == LevelOfDetail::Minimal) {
+            p.setCosmetic(true);
+            p.setWidth(1);
+        } else {
+            // Integer width, as in ConnectionPainter, so that promoting a
+            // connection does not change its thickness.
+            p.setWidth(connectionStyle.lineWidth());
+        }
+
+        painter->setPen(p);
+        painter->drawPath(batch.second);
+    }
+
+    for (Entry const &e : conversions)
+        ConnectionPainter::drawConversionLine(painter, e.path, e.color, e.inColor);
+
+    if (!endPoints.isEmpty()) {
+        painter->setPen(connectionStyle.constructionColor());
+        painter->setBrush(connectionStyle.constructionColor());
+        painter->drawPath(endPoints);
+    }
+}
+
+void ConnectionBatchItem::invalidate(ConnectionId const &connectionId, QRectF const &dirtyRect)
+{
+    _entries.erase(connectionId);
+
+    growBounds(dirtyRect);
+
+    update(dirtyRect);
+}
+
+void ConnectionBatchItem::invalidateAll()
+{
+    _entries.clear();
+
+    prepareGeometryChange();
+    _bounds = _scene.connectionIndex().boundingRect();
+
+    update();
+}
+
+bool ConnectionBatchItem::connectionAt(QPointF const &scenePos, ConnectionId &result) const
+{
+    // Half of the stroke width used by ConnectionPainter::getPainterStroke.
+    double const tolerance = 5.0;
+
+    QRectF const area(scenePos - QPointF(tolerance, tolerance),
+                      QSizeF(2 * tolerance, 2 * tolerance));
+
+    bool found = false;
+
+    auto hitTest = [&](ConnectionId const &connectionId, QRectF const &) {
+        if (found || _scene.connectionGraphicsObject(connectionId))
+            return;
+
+        if (stroke(connectionId).contains(scenePos)) {
+            result = connectionId;
+            found = true;
+        }
+    };
+
+    _scene.connectionIndex().forEachIntersecting(area, hitTest);
+
+    return found;
+}
+
+bool ConnectionBatchItem::connectionIntersects(ConnectionId const &connectionId,
+                                               QPainterPath const &sceneArea) const
+{
+    return stroke(connectionId).intersects(sceneArea);
+}
+
+QPainterPath const &ConnectionBatchItem::stroke(ConnectionId const &connectionId) const
+{
+    Entry &e = entry(connectionId);
+
+    if (e.stroke.isEmpty())
+        e.stroke = ConnectionPainter::getPainterStroke(e.path);
+
+    return e.stroke;
+}
+
+ConnectionBatchItem::Entry &ConnectionBatchItem::entry(ConnectionId const &connectionId) const
+{
+    auto it = _entries.find(connectionId);
+
+    if (it != _entries.end())
+        return it->second;
+
+    Entry &e = _entries[connectionId];
+
+    e.out = _scene.portScenePosition(connectionId.outNodeId,
+                                     PortType::Out,
+                                     connectionId.outPortIndex);
+    e.in = _scene.portScenePosition(connectionId.inNodeId, PortType::In, connectionId.inPortIndex);
+
+    if (_scene.connectionRouting() == ConnectionRouting::Orthogonal)
+        e.path = _scene.connectionRoute(connectionId);
+    else
+        e.path = ConnectionPainter::cubicPath(e.out, e.in, _scene.orientation());
+
+    auto const &connectionStyle = StyleCollection::connectionStyle();
+
+    if (connectionStyle.useDataDefinedColors()) {
+        auto const &graphModel = _scene.graphModel();
+
+        auto const dataTypeOut = graphModel
+                                     .portData(connectionId.outNodeId,
+                                               PortType::Out,
+                                               connectionId.outPortIndex,
+                                               PortRole::DataType)
+                                     .value<NodeDataType>();
+
+        auto const dataTypeIn = graphModel
+                                    .portData(connectionId.inNodeId,
+                                              PortType::In,
+                                              connectionId.inPortIndex,
+                                              PortRole::DataType)
+                                    .value<NodeDataType>();
+
+        e.color = connectionStyle.normalColor(dataTypeOut.id);
+
+        e.conversion = (dataTypeOut.id != dataTypeIn.id);
+
+        if (e.conversion)
+            e.inColor = connectionStyle.normalColor(dataTypeIn.id);
+    } else {
+        e.color = connectionStyle.normalColor();
+    }
+
+    return e;
+}
+
+void ConnectionBatchItem::growBounds(QRectF const &rect)
+{
+    if (_bounds.contains(rect))
+        return;
+
+    prepareGeometryChange();
+    _bounds = _bounds.united(rect);
+}
+
+} // namespace QtNodes
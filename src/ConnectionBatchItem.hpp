@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QtCore/QPointF>
+#include <QtCore/QRectF>
+#include <QtGui/QColor>
+#include <QtGui/QPainterPath>
+#include <QtWidgets/QGraphicsItem>
+
+#include <unordered_map>
+
+#include "ConnectionIdHash.hpp"
+#include "Definitions.hpp"
+
+namespace QtNodes {
+
+class BasicGraphicsScene;
+
+/// Single scene item drawing every connection that has no graphics object
+/// of its own. Curves are merged into one path per color so a frame costs a
+/// handful of draw calls instead of one item traversal per connection.
+/// The item has an empty shape: hit tests go through `connectionAt()` and
+/// the scene promotes the hit connection to a ConnectionGraphicsObject.
+class ConnectionBatchItem : public QGraphicsItem
+{
+public:
+    explicit ConnectionBatchItem(BasicGraphicsScene &scene);
+
+public:
+    QRectF boundingRect() const override;
+
+    QPainterPath shape() const override;
+
+    void paint(QPainter *painter,
+               QStyleOptionGraphicsItem const *option,
+               QWidget *widget = nullptr) override;
+
+    /// Drops the cached curve of the connection and repaints `dirtyRect`.
+    void invalidate(ConnectionId const &connectionId, QRectF const &dirtyRect);
+
+    /// Drops all cached curves, e.g. after a style change.
+    void invalidateAll();
+
+    /// Finds a batched connection whose stroke contains `scenePos`.
+    bool connectionAt(QPointF const &scenePos, ConnectionId &result) const;
+
+    /// Whether the stroke of a batched connection intersects `sceneArea`.
+    bool connectionIntersects(ConnectionId const &connectionId,
+                              QPainterPath const &sceneArea) const;
+
+private:
+    struct Entry
+    {
+        QPainterPath path;
+
+        /// Hit-test outline of `path`, built on the first hit test.
+        QPainterPath stroke;
+
+        QPointF out;
+        QPointF in;
+        QColor color;
+
+        /// Ports of different data types; drawn with ConnectionPainter's
+        /// two-color conversion line at full detail.
+        bool conversion = false;
+        QColor inColor;
+    };
+
+    Entry &entry(ConnectionId const &connectionId) const;
+
+    QPainterPath const &stroke(ConnectionId const &connectionId) const;
+
+    void growBounds(QRectF const &rect);
+
+private:
+    BasicGraphicsScene &_scene;
+
+    QRectF _bounds;
+
+    mutable std::unordered_map<ConnectionId, Entry> _entries;
+};
+
+} // namespace QtNodes
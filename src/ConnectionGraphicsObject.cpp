@@ -9,6 +9,7 @@
 #include "ConnectionStyle.hpp"
 #include "NodeConnectionInteraction.hpp"
 #include "NodeGraphicsObject.hpp"
+#include "PaintCounters.hpp"
 #include "StyleCollection.hpp"
 #include "locateNode.hpp"
 
@@ -31,6 +32,10 @@ ConnectionGraphicsObject::ConnectionGraphicsObject(BasicGraphicsScene &scene,
     , _connectionState(*this)
     , _out{0, 0}
     , _in{0, 0}
+    , _geometryValid(false)
+    , _strokeValid(false)
+    , _geometryOrientation(Qt::Horizontal)
+    , _geometryRouted(false)
 {
     scene.addItem(this);
 
@@ -96,16 +101,38 @@ ConnectionId const &ConnectionGraphicsObject::connectionId() const
     return _connectionId;
 }
 
-QRectF ConnectionGraphicsObject::boundingRect() const
+void ConnectionGraphicsObject::ensureGeometry() const
 {
-    auto points = pointsC1C2();
+    BasicGraphicsScene const *scene = nodeScene();
+
+    Qt::Orientation const orientation = scene ? scene->orientation() : _geometryOrientation;
 
-    // `normalized()` fixes inverted rects.
-    QRectF basicRect = QRectF(_out, _in).normalized();
+    // Draft connections follow the mouse and are never routed.
+    bool const routed = scene && scene->connectionRouting() == ConnectionRouting::Orthogonal
+                        && !_connectionState.requiresPort();
+
+    if (_geometryValid && _geometryOrientation == orientation && _geometryRouted == routed)
+        return;
 
-    QRectF c1c2Rect = QRectF(points.first, points.second).normalized();
+    _c1c2 = pointsC1C2(_out, _in, orientation);
 
-    QRectF commonRect = basicRect.united(c1c2Rect);
+    QRectF commonRect;
+
+    if (routed) {
+        _cubicPath = sceneTransform().inverted().map(scene->connectionRoute(_connectionId));
+
+        commonRect = _cubicPath.boundingRect();
+    } else {
+        _cubicPath = QPainterPath(_out);
+        _cubicPath.cubicTo(_c1c2.first, _c1c2.second, _in);
+
+        // `normalized()` fixes inverted rects.
+        QRectF basicRect = QRectF(_out, _in).normalized();
+
+        QRectF c1c2Rect = QRectF(_c1c2.first, _c1c2.second).normalized();
+
+        commonRect = basicRect.united(c1c2Rect);
+    }
 
     auto const &connectionStyle = StyleCollection::connectionStyle();
     float const diam = connectionStyle.pointDiameter();
@@ -115,7 +142,26 @@ QRectF ConnectionGraphicsObject::boundingRect() const
     commonRect.setTopLeft(commonRect.topLeft() - cornerOffset);
     commonRect.setBottomRight(commonRect.bottomRight() + 2 * cornerOffset);
 
-    return commonRect;
+    _boundingRect = commonRect;
+
+    _geometryOrientation = orientation;
+    _geometryRouted = routed;
+    _geometryValid = true;
+    _strokeValid = false;
+}
+
+QRectF ConnectionGraphicsObject::boundingRect() const
+{
+    ensureGeometry();
+
+    return _boundingRect;
+}
+
+QPainterPath const &ConnectionGraphicsObject::cubicPath() const
+{
+    ensureGeometry();
+
+    return _cubicPath;
 }
 
 QPainterPath ConnectionGraphicsObject::shape() const
@@ -128,7 +174,15 @@ QPainterPath ConnectionGraphicsObject::shape() const
     //return path;
 
 #else
-    return ConnectionPainter::getPainterStroke(*this);
+    ensureGeometry();
+
+    // Only needed for hit tests, so built on first use.
+    if (!_strokeValid) {
+        _stroke = ConnectionPainter::getPainterStroke(_cubicPath);
+        _strokeValid = true;
+    }
+
+    return _stroke;
 #endif
 }
 
@@ -141,10 +195,16 @@ QPointF const &ConnectionGraphicsObject::endPoint(PortType portType) const
 
 void ConnectionGraphicsObject::setEndPoint(PortType portType, QPointF const &point)
 {
-    if (portType == PortType::In)
-        _in = point;
-    else
-        _out = point;
+    QPointF &end = (portType == PortType::In) ? _in : _out;
+
+    if (end == point)
+        return;
+
+    prepareGeometryChange();
+
+    end = point;
+
+    _geometryValid = false;
 }
 
 void ConnectionGraphicsObject::move()
@@ -155,27 +215,39 @@ void ConnectionGraphicsObject::move()
         if (nodeId == InvalidNodeId)
             return;
 
-        NodeGraphicsObject *ngo = nodeScene()->nodeGraphicsObject(nodeId);
-
-        if (ngo) {
-            AbstractNodeGeometry &geometry = nodeScene()->nodeGeometry();
-
-            QPointF scenePos = geometry.portScenePosition(nodeId,
+        // Also valid when the node has no graphics object in a virtualized scene.
+        QPointF scenePos = nodeScene()->portScenePosition(nodeId,
                                                           portType,
-                                                          getPortIndex(portType, cId),
-                                                          ngo->sceneTransform());
+                                                          getPortIndex(portType, cId));
 
-            QPointF connectionPos = sceneTransform().inverted().map(scenePos);
+        QPointF connectionPos = sceneTransform().inverted().map(scenePos);
 
-            setEndPoint(portType, connectionPos);
-        }
+        setEndPoint(portType, connectionPos);
     };
 
     moveEnd(_connectionId, PortType::Out);
     moveEnd(_connectionId, PortType::In);
 
+    // setEndPoint() drops the cached geometry only when an end actually moved.
+    if (_geometryValid)
+        return;
+
+    // Draft connections are not indexed.
+    if (nodeScene()->connectionGraphicsObject(_connectionId) == this)
+        nodeScene()->updateConnectionIndex(_connectionId, sceneBoundingRect());
+
+    update();
+}
+
+void ConnectionGraphicsObject::invalidateGeometry()
+{
     prepareGeometryChange();
 
+    _geometryValid = false;
+
+    if (nodeScene()->connectionGraphicsObject(_connectionId) == this)
+        nodeScene()->updateConnectionIndex(_connectionId, sceneBoundingRect());
+
     update();
 }
 
@@ -196,9 +268,16 @@ void ConnectionGraphicsObject::paint(QPainter *painter,
     if (!scene())
         return;
 
+    PaintCounters::add(PaintCounters::ConnectionPaints);
+
     painter->setClipRect(option->exposedRect);
 
-    ConnectionPainter::paint(painter, *this);
+    double const scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform());
+
+    ConnectionPainter::paint(painter,
+                             *this,
+                             StyleCollection::flowViewStyle().levelOfDetail(scale));
 }
 
 void ConnectionGraphicsObject::mousePressEvent(QGraphicsSceneMouseEvent *event)
@@ -289,13 +368,22 @@ void ConnectionGraphicsObject::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
 
 std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2() const
 {
-    switch (nodeScene()->orientation()) {
+    ensureGeometry();
+
+    return _c1c2;
+}
+
+std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2(QPointF const &out,
+                                                                 QPointF const &in,
+                                                                 Qt::Orientation orientation)
+{
+    switch (orientation) {
     case Qt::Horizontal:
-        return pointsC1C2Horizontal();
+        return pointsC1C2Horizontal(out, in);
         break;
 
     case Qt::Vertical:
-        return pointsC1C2Vertical();
+        return pointsC1C2Vertical(out, in);
         break;
     }
 
@@ -315,11 +403,12 @@ void ConnectionGraphicsObject::addGraphicsEffect()
     //effect->setColor(QColor(Qt::gray).darker(800));
 }
 
-std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2Horizontal() const
+std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2Horizontal(QPointF const &out,
+                                                                           QPointF const &in)
 {
     double const defaultOffset = 200;
 
-    double xDistance = _in.x() - _out.x();
+    double xDistance = in.x() - out.x();
 
     double horizontalOffset = qMin(defaultOffset, std::abs(xDistance));
 
@@ -328,7 +417,7 @@ std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2Horizontal() con
     double ratioX = 0.5;
 
     if (xDistance <= 0) {
-        double yDistance = _in.y() - _out.y() + 20;
+        double yDistance = in.y() - out.y() + 20;
 
         double vector = yDistance < 0 ? -1.0 : 1.0;
 
@@ -339,18 +428,19 @@ std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2Horizontal() con
 
     horizontalOffset *= ratioX;
 
-    QPointF c1(_out.x() + horizontalOffset, _out.y() + verticalOffset);
+    QPointF c1(out.x() + horizontalOffset, out.y() + verticalOffset);
 
-    QPointF c2(_in.x() - horizontalOffset, _in.y() - verticalOffset);
+    QPointF c2(in.x() - horizontalOffset, in.y() - verticalOffset);
 
     return std::make_pair(c1, c2);
 }
 
-std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2Vertical() const
+std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2Vertical(QPointF const &out,
+                                                                         QPointF const &in)
 {
     double const defaultOffset = 200;
 
-    double yDistance = _in.y() - _out.y();
+    double yDistance = in.y() - out.y();
 
     double verticalOffset = qMin(defaultOffset, std::abs(yDistance));
 
@@ -359,7 +449,7 @@ std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2Vertical() const
     double ratioY = 0.5;
 
     if (yDistance <= 0) {
-        double xDistance = _in.x() - _out.x() + 20;
+        double xDistance = in.x() - out.x() + 20;
 
         double vector = xDistance < 0 ? -1.0 : 1.0;
 
@@ -370,9 +460,9 @@ std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2Vertical() const
 
     verticalOffset *= ratioY;
 
-    QPointF c1(_out.x() + horizontalOffset, _out.y() + verticalOffset);
+    QPointF c1(out.x() + horizontalOffset, out.y() + verticalOffset);
 
-    QPointF c2(_in.x() - horizontalOffset, _in.y() - verticalOffset);
+    QPointF c2(in.x() - horizontalOffset, in.y() - verticalOffset);
 
     return std::make_pair(c1, c2);
 }
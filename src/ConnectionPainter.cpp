@@ -11,12 +11,11 @@
 
 namespace QtNodes {
 
-static QPainterPath cubicPath(ConnectionGraphicsObject const &connection)
+QPainterPath ConnectionPainter::cubicPath(QPointF const &out,
+                                         QPointF const &in,
+                                         Qt::Orientation orientation)
 {
-    QPointF const &in = connection.endPoint(PortType::In);
-    QPointF const &out = connection.endPoint(PortType::Out);
-
-    auto const c1c2 = connection.pointsC1C2();
+    auto const c1c2 = ConnectionGraphicsObject::pointsC1C2(out, in, orientation);
 
     // cubic spline
     QPainterPath cubic(out);
@@ -28,10 +27,24 @@ static QPainterPath cubicPath(ConnectionGraphicsObject const &connection)
 
 QPainterPath ConnectionPainter::getPainterStroke(ConnectionGraphicsObject const &connection)
 {
-    auto cubic = cubicPath(connection);
+    return getPainterStroke(connection.cubicPath());
+}
+
+QPainterPath ConnectionPainter::getPainterStroke(QPainterPath const &cubic)
+{
+    QPainterPathStroker stroker;
+    stroker.setWidth(10.0);
+
+    // Orthogonal routes are already polylines; sampling would cut corners.
+    bool curved = false;
+
+    for (int i = 0; i < cubic.elementCount() && !curved; ++i)
+        curved = cubic.elementAt(i).isCurveTo();
 
-    QPointF const &out = connection.endPoint(PortType::Out);
-    QPainterPath result(out);
+    if (!curved)
+        return stroker.createStroke(cubic);
+
+    QPainterPath result(cubic.pointAtPercent(0.0));
 
     unsigned segments = 20;
 
@@ -40,9 +53,6 @@ QPainterPath ConnectionPainter::getPainterStroke(ConnectionGraphicsObject const
         result.lineTo(cubic.pointAtPercent(ratio));
     }
 
-    QPainterPathStroker stroker;
-    stroker.setWidth(10.0);
-
     return stroker.createStroke(result);
 }
 
@@ -67,7 +77,7 @@ static void debugDrawing(QPainter *painter, ConnectionGraphicsObject const &cgo)
         painter->drawEllipse(points.second, 3, 3);
 
         painter->setBrush(Qt::NoBrush);
-        painter->drawPath(cubicPath(cgo));
+        painter->drawPath(cgo.cubicPath());
     }
 
     {
@@ -93,7 +103,7 @@ static void drawSketchLine(QPainter *painter, ConnectionGraphicsObject const &cg
         painter->setPen(pen);
         painter->setBrush(Qt::NoBrush);
 
-        auto cubic = cubicPath(cgo);
+        auto const &cubic = cgo.cubicPath();
 
         // cubic spline
         painter->drawPath(cubic);
@@ -120,12 +130,43 @@ static void drawHoveredOrSelected(QPainter *painter, ConnectionGraphicsObject co
         painter->setBrush(Qt::NoBrush);
 
         // cubic spline
-        auto const cubic = cubicPath(cgo);
+        auto const &cubic = cgo.cubicPath();
         painter->drawPath(cubic);
     }
 }
 
-static void drawNormalLine(QPainter *painter, ConnectionGraphicsObject const &cgo)
+static void drawStraightLine(QPainter *painter, ConnectionGraphicsObject const &cgo)
+{
+    auto const &connectionStyle = QtNodes::StyleCollection::connectionStyle();
+
+    QPen pen;
+    pen.setCosmetic(true);
+
+    if (cgo.connectionState().requiresPort()) {
+        pen.setColor(connectionStyle.constructionColor());
+        pen.setStyle(Qt::DashLine);
+    } else {
+        pen.setColor(cgo.isSelected() ? connectionStyle.selectedColor()
+                                      : connectionStyle.normalColor());
+    }
+
+    painter->setPen(pen);
+    painter->setBrush(Qt::NoBrush);
+
+    painter->drawLine(cgo.endPoint(PortType::Out), cgo.endPoint(PortType::In));
+}
+
+/// Marker drawn on connections between different data types, loaded once.
+static QImage const &convertIcon()
+{
+    static QImage const icon = QIcon(":convert.png").pixmap(QSize(22, 22)).toImage();
+
+    return icon;
+}
+
+static void drawNormalLine(QPainter *painter,
+                           ConnectionGraphicsObject const &cgo,
+                           LevelOfDetail const lod)
 {
     ConnectionState const &state = cgo.connectionState();
 
@@ -142,6 +183,8 @@ static void drawNormalLine(QPainter *painter, ConnectionGraphicsObject const &cg
 
     bool useGradientColor = false;
 
+    QString dataTypeOutId;
+
     AbstractGraphModel const &graphModel = cgo.graphModel();
 
     if (connectionStyle.useDataDefinedColors()) {
@@ -162,6 +205,8 @@ static void drawNormalLine(QPainter *painter, ConnectionGraphicsObject const &cg
 
         useGradientColor = (dataTypeOut.id != dataTypeIn.id);
 
+        dataTypeOutId = dataTypeOut.id;
+
         normalColorOut = connectionStyle.normalColor(dataTypeOut.id);
         normalColorIn = connectionStyle.normalColor(dataTypeIn.id);
         selectedColor = normalColorOut.darker(200);
@@ -178,67 +223,89 @@ static void drawNormalLine(QPainter *painter, ConnectionGraphicsObject const &cg
 
     bool const selected = cgo.isSelected();
 
-    auto cubic = cubicPath(cgo);
-    if (useGradientColor) {
-        painter->setBrush(Qt::NoBrush);
-
+    auto const &cubic = cgo.cubicPath();
+    if (useGradientColor && lod == LevelOfDetail::Full) {
         QColor cOut = normalColorOut;
-        if (selected)
-            cOut = cOut.darker(200);
-        p.setColor(cOut);
-        painter->setPen(p);
-
-        unsigned int const segments = 60;
+        QColor cIn = normalColorIn;
 
-        for (unsigned int i = 0ul; i < segments; ++i) {
-            double ratioPrev = double(i) / segments;
-            double ratio = double(i + 1) / segments;
-
-            if (i == segments / 2) {
-                QColor cIn = normalColorIn;
-                if (selected)
-                    cIn = cIn.darker(200);
-
-                p.setColor(cIn);
-                painter->setPen(p);
-            }
-            painter->drawLine(cubic.pointAtPercent(ratioPrev), cubic.pointAtPercent(ratio));
+        if (selected) {
+            cOut = cOut.darker(200);
+            cIn = cIn.darker(200);
         }
 
-        {
-            QIcon icon(":convert.png");
-
-            QPixmap pixmap = icon.pixmap(QSize(22, 22));
-            painter->drawPixmap(cubic.pointAtPercent(0.50)
-                                    - QPoint(pixmap.width() / 2, pixmap.height() / 2),
-                                pixmap);
-        }
+        ConnectionPainter::drawConversionLine(painter, cubic, cOut, cIn);
     } else {
-        p.setColor(normalColorOut);
-
         if (selected) {
             p.setColor(selectedColor);
+            painter->setPen(p);
+        } else if (connectionStyle.useDataDefinedColors()) {
+            painter->setPen(connectionStyle.normalPen(dataTypeOutId));
+        } else {
+            p.setColor(normalColorOut);
+            painter->setPen(p);
         }
 
-        painter->setPen(p);
         painter->setBrush(Qt::NoBrush);
 
         painter->drawPath(cubic);
     }
 }
 
-void ConnectionPainter::paint(QPainter *painter, ConnectionGraphicsObject const &cgo)
+void ConnectionPainter::drawConversionLine(QPainter *painter,
+                                           QPainterPath const &cubic,
+                                           QColor const &outColor,
+                                           QColor const &inColor)
+{
+    QPen p;
+
+    p.setWidth(StyleCollection::connectionStyle().lineWidth());
+    p.setColor(outColor);
+
+    painter->setBrush(Qt::NoBrush);
+    painter->setPen(p);
+
+    unsigned int const segments = 60;
+
+    for (unsigned int i = 0ul; i < segments; ++i) {
+        double ratioPrev = double(i) / segments;
+        double ratio = double(i + 1) / segments;
+
+        if (i == segments / 2) {
+            p.setColor(inColor);
+            painter->setPen(p);
+        }
+        painter->drawLine(cubic.pointAtPercent(ratioPrev), cubic.pointAtPercent(ratio));
+    }
+
+    QImage const &icon = convertIcon();
+
+    painter->drawImage(cubic.pointAtPercent(0.50) - QPoint(icon.width() / 2, icon.height() / 2),
+                       icon);
+}
+
+void ConnectionPainter::paint(QPainter *painter,
+                              ConnectionGraphicsObject const &cgo,
+                              LevelOfDetail lod)
 {
+    if (lod == LevelOfDetail::Minimal) {
+        drawStraightLine(painter, cgo);
+        return;
+    }
+
     drawHoveredOrSelected(painter, cgo);
 
     drawSketchLine(painter, cgo);
 
-    drawNormalLine(painter, cgo);
+    drawNormalLine(painter, cgo, lod);
 
 #ifdef NODE_DEBUG_DRAWING
     debugDrawing(painter, cgo);
 #endif
 
+    // End points are smaller than a pixel at reduced detail.
+    if (lod != LevelOfDetail::Full)
+        return;
+
     // draw end points
     auto const &connectionStyle = QtNodes::StyleCollection::connectionStyle();
 
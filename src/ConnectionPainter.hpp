@@ -13,9 +13,29 @@ class ConnectionGraphicsObject;
 class ConnectionPainter
 {
 public:
-    static void paint(QPainter *painter, ConnectionGraphicsObject const &cgo);
+    /// Paints the connection; lower detail tiers drop end points, gradients
+    /// and finally the curve itself in favour of a straight line.
+    static void paint(QPainter *painter,
+                      ConnectionGraphicsObject const &cgo,
+                      LevelOfDetail lod = LevelOfDetail::Full);
+
+    /// Line between ports of different data types: half in each port's color,
+    /// with the conversion icon in the middle.
+    static void drawConversionLine(QPainter *painter,
+                                   QPainterPath const &cubic,
+                                   QColor const &outColor,
+                                   QColor const &inColor);
 
     static QPainterPath getPainterStroke(ConnectionGraphicsObject const &cgo);
+
+    /// Hit-test stroke around a connection curve or orthogonal route.
+    static QPainterPath getPainterStroke(QPainterPath const &cubic);
+
+    /// Connection curve between two scene points, for callers that draw
+    /// connections without a ConnectionGraphicsObject.
+    static QPainterPath cubicPath(QPointF const &out,
+                                  QPointF const &in,
+                                  Qt::Orientation orientation);
 };
 
 } // namespace QtNodes
@@ -0,0 +1,432 @@
+#include "ConnectionRouter.hpp"
+
+#include "AbstractGraphModel.hpp"
+#include "AbstractNodeGeometry.hpp"
+#include "BasicGraphicsScene.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace QtNodes {
+
+namespace {
+
+// Straight segment the route keeps after leaving and before entering a port.
+double const StubLength = 20.0;
+
+// Clearance between routes and node rectangles; less than `StubLength`.
+double const ObstacleMargin = 10.0;
+
+// Free space around the ends in which routes may detour.
+double const RoutingMargin = 60.0;
+
+// Extra cost of a corner, in scene units.
+double const BendPenalty = 40.0;
+
+// Beyond this many nodes near a connection it gets a simple route.
+std::size_t const MaxObstacles = 100;
+
+// Finest spacing of the bundling lattice and cost factor along its lines.
+double const BundleSpacing = 40.0;
+double const BundleCostFactor = 0.6;
+
+// The lattice spacing doubles until a routing area has at most this many lines.
+int const MaxBundleLines = 32;
+
+enum Direction { PlusX = 0, MinusX = 1, PlusY = 2, MinusY = 3 };
+
+/// Drops points that lie on the segment between their neighbours.
+std::vector<QPointF> simplified(std::vector<QPointF> const &points)
+{
+    std::vector<QPointF> result;
+
+    for (QPointF const &p : points) {
+        if (!result.empty() && result.back() == p)
+            continue;
+
+        if (result.size() >= 2) {
+            QPointF const &a = result[result.size() - 2];
+            QPointF const &b = result.back();
+
+            // Route points are taken from the same grid coordinates.
+            bool const sameX = (a.x() == b.x() && b.x() == p.x());
+            bool const sameY = (a.y() == b.y() && b.y() == p.y());
+
+            if (sameX || sameY)
+                result.back() = p;
+            else
+                result.push_back(p);
+        } else {
+            result.push_back(p);
+        }
+    }
+
+    return result;
+}
+
+/// Sorted, deduplicated coordinates.
+void normalize(std::vector<double> &values)
+{
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+int indexOf(std::vector<double> const &values, double value)
+{
+    return static_cast<int>(std::lower_bound(values.begin(), values.end(), value)
+                            - values.begin());
+}
+
+/// Lattice lines within [min, max] for bundling.
+void addBundleLines(std::vector<double> &values, double min, double max)
+{
+    double spacing = BundleSpacing;
+
+    while ((max - min) / spacing > MaxBundleLines)
+        spacing *= 2.0;
+
+    for (double v = std::ceil(min / spacing) * spacing; v <= max; v += spacing)
+        values.push_back(v);
+}
+
+bool onBundleLine(double value)
+{
+    // Every lattice spacing is a multiple of the finest one.
+    double const r = std::fmod(std::abs(value), BundleSpacing);
+
+    return r < 1e-6 || BundleSpacing - r < 1e-6;
+}
+
+} // namespace
+
+ConnectionRouter::ConnectionRouter(BasicGraphicsScene &scene)
+    : _scene(scene)
+    , _bundlingEnabled(false)
+{}
+
+void ConnectionRouter::setBundlingEnabled(bool enabled)
+{
+    _bundlingEnabled = enabled;
+
+    invalidateAll();
+}
+
+QPainterPath const &ConnectionRouter::route(ConnectionId const &connectionId) const
+{
+    auto it = _routes.find(connectionId);
+
+    if (it == _routes.end())
+        it = _routes.emplace(connectionId, computeRoute(connectionId)).first;
+
+    return it->second;
+}
+
+QRectF ConnectionRouter::routingArea(ConnectionId const &connectionId) const
+{
+    return routingArea(connectionId, ends(connectionId));
+}
+
+void ConnectionRouter::invalidate(ConnectionId const &connectionId)
+{
+    _routes.erase(connectionId);
+}
+
+void ConnectionRouter::invalidateAll()
+{
+    _routes.clear();
+}
+
+ConnectionRouter::Ends ConnectionRouter::ends(ConnectionId const &connectionId) const
+{
+    Ends e;
+
+    e.out = _scene.portScenePosition(connectionId.outNodeId,
+                                     PortType::Out,
+                                     connectionId.outPortIndex);
+    e.in = _scene.portScenePosition(connectionId.inNodeId, PortType::In, connectionId.inPortIndex);
+
+    // Connections leave nodes in the flow direction of the scene.
+    QPointF const stub = (_scene.orientation() == Qt::Horizontal) ? QPointF(StubLength, 0.0)
+                                                                   : QPointF(0.0, StubLength);
+
+    e.outStub = e.out + stub;
+    e.inStub = e.in - stub;
+
+    return e;
+}
+
+QRectF ConnectionRouter::routingArea(ConnectionId const &connectionId, Ends const &e) const
+{
+    // Backward connections have to lead around their own nodes.
+    QRectF const area = QRectF(e.outStub, e.inStub)
+                            .normalized()
+                            .united(nodeRect(connectionId.outNodeId))
+                            .united(nodeRect(connectionId.inNodeId));
+
+    return area.adjusted(-RoutingMargin, -RoutingMargin, RoutingMargin, RoutingMargin);
+}
+
+QRectF ConnectionRouter::nodeRect(NodeId const nodeId) const
+{
+    QPointF const pos = _scene.graphModel().nodeData<QPointF>(nodeId, NodeRole::Position);
+
+    QRectF const rect(pos, _scene.nodeGeometry().size(nodeId));
+
+    return rect.adjusted(-ObstacleMargin, -ObstacleMargin, ObstacleMargin, ObstacleMargin);
+}
+
+std::vector<QPointF> ConnectionRouter::findPath(Ends const &e,
+                                                QRectF const &area,
+                                                std::vector<QRectF> const &obstacles) const
+{
+    std::vector<double> xs{area.left(), area.right(), e.outStub.x(), e.inStub.x()};
+    std::vector<double> ys{area.top(), area.bottom(), e.outStub.y(), e.inStub.y()};
+
+    std::vector<QRectF> clipped;
+    clipped.reserve(obstacles.size());
+
+    for (QRectF const &obstacle : obstacles) {
+        QRectF const r = obstacle.intersected(area);
+
+        if (r.isEmpty())
+            continue;
+
+        clipped.push_back(r);
+
+        xs.push_back(r.left());
+        xs.push_back(r.right());
+        ys.push_back(r.top());
+        ys.push_back(r.bottom());
+    }
+
+    if (_bundlingEnabled) {
+        addBundleLines(xs, area.left(), area.right());
+        addBundleLines(ys, area.top(), area.bottom());
+    }
+
+    normalize(xs);
+    normalize(ys);
+
+    int const nx = static_cast<int>(xs.size());
+    int const ny = static_cast<int>(ys.size());
+
+    auto vertex = [nx](int i, int j) { return j * nx + i; };
+
+    // Grid segments running through the inside of a node.
+    std::vector<char> blockedX(nx * ny, 0); // (i, j) -> (i + 1, j)
+    std::vector<char> blockedY(nx * ny, 0); // (i, j) -> (i, j + 1)
+
+    for (QRectF const &r : clipped) {
+        int const x0 = indexOf(xs, r.left());
+        int const x1 = indexOf(xs, r.right());
+        int const y0 = indexOf(ys, r.top());
+        int const y1 = indexOf(ys, r.bottom());
+
+        for (int j = y0 + 1; j < y1; ++j) {
+            for (int i = x0; i < x1; ++i)
+                blockedX[vertex(i, j)] = 1;
+        }
+
+        for (int j = y0; j < y1; ++j) {
+            for (int i = x0 + 1; i < x1; ++i)
+                blockedY[vertex(i, j)] = 1;
+        }
+    }
+
+    bool const horizontal = (_scene.orientation() == Qt::Horizontal);
+
+    // Routes leave and enter the stubs in the flow direction.
+    int const flowDirection = horizontal ? PlusX : PlusY;
+
+    int const start = vertex(indexOf(xs, e.outStub.x()), indexOf(ys, e.outStub.y()));
+    int const goal = vertex(indexOf(xs, e.inStub.x()), indexOf(ys, e.inStub.y()));
+
+    double const minCostFactor = _bundlingEnabled ? BundleCostFactor : 1.0;
+
+    auto heuristic = [&](int v) {
+        return minCostFactor
+               * (std::abs(xs[v % nx] - e.inStub.x()) + std::abs(ys[v / nx] - e.inStub.y()));
+    };
+
+    // A state is a vertex with the direction it was entered in; the extra
+    // last state stands for having arrived at the goal.
+    int const stateCount = nx * ny * 4;
+    int const arrived = stateCount;
+
+    std::vector<double> cost(stateCount + 1, std::numeric_limits<double>::max());
+    std::vector<int> parent(stateCount + 1, -1);
+
+    using Entry = std::pair<double, int>;
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    int const startState = start * 4 + flowDirection;
+
+    cost[startState] = 0.0;
+    open.emplace(heuristic(start), startState);
+
+    while (!open.empty()) {
+        Entry const top = open.top();
+        open.pop();
+
+        int const state = top.second;
+
+        if (state == arrived)
+            break;
+
+        int const v = state / 4;
+        int const direction = state % 4;
+
+        double const g = cost[state];
+
+        if (top.first > g + heuristic(v))
+            continue;
+
+        if (v == goal) {
+            double const total = g + (direction == flowDirection ? 0.0 : BendPenalty);
+
+            if (total < cost[arrived]) {
+                cost[arrived] = total;
+                parent[arrived] = state;
+                open.emplace(total, arrived);
+            }
+        }
+
+        int const i = v % nx;
+        int const j = v / nx;
+
+        for (int next = 0; next < 4; ++next) {
+            // Turning back is never shorter.
+            if ((next ^ 1) == direction)
+                continue;
+
+            int ni = i;
+            int nj = j;
+            bool blocked = false;
+
+            switch (next) {
+            case PlusX:
+                ni = i + 1;
+                blocked = ni >= nx || blockedX[vertex(i, j)];
+                break;
+            case MinusX:
+                ni = i - 1;
+                blocked = ni < 0 || blockedX[vertex(ni, j)];
+                break;
+            case PlusY:
+                nj = j + 1;
+                blocked = nj >= ny || blockedY[vertex(i, j)];
+                break;
+            case MinusY:
+                nj = j - 1;
+                blocked = nj < 0 || blockedY[vertex(i, nj)];
+                break;
+            }
+
+            if (blocked)
+                continue;
+
+            bool const alongX = (next == PlusX || next == MinusX);
+
+            double length = alongX ? std::abs(xs[ni] - xs[i]) : std::abs(ys[nj] - ys[j]);
+
+            if (_bundlingEnabled && onBundleLine(alongX ? ys[j] : xs[i]))
+                length *= BundleCostFactor;
+
+            double const nextCost = g + length + (next == direction ? 0.0 : BendPenalty);
+
+            int const nv = vertex(ni, nj);
+            int const nextState = nv * 4 + next;
+
+            if (nextCost < cost[nextState]) {
+                cost[nextState] = nextCost;
+                parent[nextState] = state;
+                open.emplace(nextCost + heuristic(nv), nextState);
+            }
+        }
+    }
+
+    if (parent[arrived] < 0)
+        return {};
+
+    std::vector<QPointF> path;
+
+    for (int state = parent[arrived]; state >= 0; state = parent[state]) {
+        int const v = state / 4;
+        path.emplace_back(xs[v % nx], ys[v / nx]);
+    }
+
+    std::reverse(path.begin(), path.end());
+
+    return path;
+}
+
+std::vector<QPointF> ConnectionRouter::simplePath(Ends const &e) const
+{
+    QPointF const &a = e.outStub;
+    QPointF const &b = e.inStub;
+
+    bool const horizontal = (_scene.orientation() == Qt::Horizontal);
+
+    // Forward connections bend halfway between the ends; backward ones run
+    // back across the flow direction.
+    if (horizontal) {
+        if (b.x() >= a.x()) {
+            double const x = (a.x() + b.x()) / 2.0;
+            return {a, QPointF(x, a.y()), QPointF(x, b.y()), b};
+        }
+
+        double const y = (a.y() + b.y()) / 2.0;
+        return {a, QPointF(a.x(), y), QPointF(b.x(), y), b};
+    }
+
+    if (b.y() >= a.y()) {
+        double const y = (a.y() + b.y()) / 2.0;
+        return {a, QPointF(a.x(), y), QPointF(b.x(), y), b};
+    }
+
+    double const x = (a.x() + b.x()) / 2.0;
+    return {a, QPointF(x, a.y()), QPointF(x, b.y()), b};
+}
+
+QPainterPath ConnectionRouter::computeRoute(ConnectionId const &connectionId) const
+{
+    Ends const e = ends(connectionId);
+
+    QRectF const area = routingArea(connectionId, e);
+
+    std::vector<NodeId> const nodes = _scene.nodesInRect(area);
+
+    std::vector<QPointF> path;
+
+    if (nodes.size() <= MaxObstacles) {
+        std::vector<QRectF> obstacles;
+        obstacles.reserve(nodes.size());
+
+        for (NodeId const nodeId : nodes)
+            obstacles.push_back(nodeRect(nodeId));
+
+        path = findPath(e, area, obstacles);
+    }
+
+    // Overlapping nodes may leave no way through.
+    if (path.empty())
+        path = simplePath(e);
+
+    path.insert(path.begin(), e.out);
+    path.push_back(e.in);
+
+    path = simplified(path);
+
+    QPainterPath result(path.front());
+
+    for (std::size_t i = 1; i < path.size(); ++i)
+        result.lineTo(path[i]);
+
+    return result;
+}
+
+} // namespace QtNodes
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QtCore/QPointF>
+#include <QtCore/QRectF>
+#include <QtGui/QPainterPath>
+
+#include <unordered_map>
+#include <vector>
+
+#include "ConnectionIdHash.hpp"
+#include "Definitions.hpp"
+
+namespace QtNodes {
+
+class BasicGraphicsScene;
+
+/// Computes orthogonal connection routes that lead around node rectangles.
+///
+/// Each route is searched in a sparse orthogonal visibility graph: the grid
+/// spanned by the edges of the nodes near the connection, the port stubs and
+/// the border of the routing area. A* with a penalty per bend picks the
+/// shortest route with few corners. With bundling enabled the grid also holds
+/// a coarse lattice that is cheaper to travel along, so that parallel routes
+/// share segments.
+///
+/// Routes are cached per connection; the scene invalidates the connections
+/// attached to or passing by a node that moved.
+class ConnectionRouter
+{
+public:
+    ConnectionRouter(BasicGraphicsScene &scene);
+
+public:
+    bool bundlingEnabled() const { return _bundlingEnabled; }
+
+    /// Changes the routing cost model; drops all cached routes.
+    void setBundlingEnabled(bool enabled);
+
+    /// Polyline from the output port to the input port in scene coordinates.
+    QPainterPath const &route(ConnectionId const &connectionId) const;
+
+    /// Scene area the route stays within. Cheaper than `route()`, for indexing.
+    QRectF routingArea(ConnectionId const &connectionId) const;
+
+    void invalidate(ConnectionId const &connectionId);
+
+    void invalidateAll();
+
+private:
+    struct Ends
+    {
+        QPointF out;
+        QPointF in;
+
+        /// Points where the route leaves the output and enters the input node.
+        QPointF outStub;
+        QPointF inStub;
+    };
+
+    Ends ends(ConnectionId const &connectionId) const;
+
+    QRectF routingArea(ConnectionId const &connectionId, Ends const &e) const;
+
+    QRectF nodeRect(NodeId const nodeId) const;
+
+    /// Points of the route between the stubs, or an empty vector if there is none.
+    std::vector<QPointF> findPath(Ends const &e,
+                                  QRectF const &area,
+                                  std::vector<QRectF> const &obstacles) const;
+
+    /// Route with at most two bends that ignores obstacles.
+    std::vector<QPointF> simplePath(Ends const &e) const;
+
+    QPainterPath computeRoute(ConnectionId const &connectionId) const;
+
+private:
+    BasicGraphicsScene &_scene;
+
+    bool _bundlingEnabled;
+
+    mutable std::unordered_map<ConnectionId, QPainterPath> _routes;
+};
+
+} // namespace QtNodes
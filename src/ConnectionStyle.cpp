@@ -105,6 +105,9 @@ void ConnectionStyle::setConnectionStyle(QString jsonText)
 
 void ConnectionStyle::loadJson(QJsonObject const &json)
 {
+    // The line width may change.
+    _typePens.clear();
+
     QJsonValue nodeStyleValues = json["ConnectionStyle"];
 
     QJsonObject obj = nodeStyleValues.toObject();
@@ -156,6 +159,11 @@ QColor ConnectionStyle::normalColor() const
 
 QColor ConnectionStyle::normalColor(QString typeId) const
 {
+    auto it = _typeColors.find(typeId);
+
+    if (it != _typeColors.end())
+        return it->second;
+
     std::size_t hash = qHash(typeId);
 
     std::size_t const hue_range = 0xFF;
@@ -166,7 +174,25 @@ QColor ConnectionStyle::normalColor(QString typeId) const
     int hue = distrib(gen);
     int sat = 120 + hash % 129;
 
-    return QColor::fromHsl(hue, sat, 160);
+    QColor const color = QColor::fromHsl(hue, sat, 160);
+
+    _typeColors.emplace(typeId, color);
+
+    return color;
+}
+
+QPen const &ConnectionStyle::normalPen(QString const &typeId) const
+{
+    auto it = _typePens.find(typeId);
+
+    if (it == _typePens.end()) {
+        QPen pen(normalColor(typeId));
+        pen.setWidth(LineWidth);
+
+        it = _typePens.emplace(typeId, pen).first;
+    }
+
+    return it->second;
 }
 
 QColor ConnectionStyle::selectedColor() const
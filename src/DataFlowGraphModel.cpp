@@ -52,6 +52,11 @@ std::unordered_set<ConnectionId> DataFlowGraphModel::connections(NodeId nodeId,
     return result;
 }
 
+std::unordered_set<ConnectionId> DataFlowGraphModel::allConnections() const
+{
+    return _connectivity;
+}
+
 bool DataFlowGraphModel::connectionExists(ConnectionId const connectionId) const
 {
     return (_connectivity.find(connectionId) != _connectivity.end());
@@ -105,6 +110,17 @@ NodeId DataFlowGraphModel::addNode(QString const nodeType)
                 this,
                 &DataFlowGraphModel::portsInserted);
 
+        /**嵌入控件尺寸变化，需要重新布局 */
+        connect(model.get(),
+                &NodeDelegateModel::embeddedWidgetSizeUpdated,
+                this,
+                [newId, this]() { Q_EMIT nodeUpdated(newId); });
+
+        connect(model.get(),
+                &NodeDelegateModel::nodeStyleUpdated,
+                this,
+                [newId, this]() { Q_EMIT nodeUpdated(newId); });
+
         _models[newId] = std::move(model);
         Q_EMIT nodeCreated(newId);
         return newId;
@@ -222,7 +238,7 @@ QVariant DataFlowGraphModel::nodeData(NodeId nodeId, NodeRole role) const
         break;
 
     case NodeRole::Style: {
-        auto style = StyleCollection::nodeStyle();
+        auto const &style = model->nodeStyle();
         result = style.toJson().toVariantMap();
     } break;
 
@@ -246,6 +262,7 @@ QVariant DataFlowGraphModel::nodeData(NodeId nodeId, NodeRole role) const
     case NodeRole::Widget: {
         auto w = model->embeddedWidget();
         result = QVariant::fromValue(w);
+        _embeddedWidgetNodes.insert(nodeId);
         break;
     } 
 
@@ -255,11 +272,25 @@ QVariant DataFlowGraphModel::nodeData(NodeId nodeId, NodeRole role) const
         break;
     }
 
+    case NodeRole::WidgetSizeHint:
+        // Once created, the widget's own size is used.
+        if (_embeddedWidgetNodes.find(nodeId) == _embeddedWidgetNodes.end())
+            result = model->embeddedWidgetSizeHint();
+        break;
     }
 
     return result;
 }
 
+std::shared_ptr<NodeStyle const> DataFlowGraphModel::nodeStyle(NodeId nodeId) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return AbstractGraphModel::nodeStyle(nodeId);
+
+    return it->second->sharedNodeStyle();
+}
+
 NodeFlags DataFlowGraphModel::nodeFlags(NodeId nodeId) const
 {
     auto it = _models.find(nodeId);
@@ -314,6 +345,12 @@ bool DataFlowGraphModel::setNodeData(NodeId nodeId, NodeRole role, QVariant valu
 
     case NodeRole::Widget:
         break;
+
+    case NodeRole::Widget_detailedSettings:
+        break;
+
+    case NodeRole::WidgetSizeHint:
+        break;
     }
 
     return result;
@@ -420,6 +457,7 @@ bool DataFlowGraphModel::deleteNode(NodeId const nodeId)
     }
 
     _nodeGeometryData.erase(nodeId);
+    _embeddedWidgetNodes.erase(nodeId);
     _models.erase(nodeId);
 
     Q_EMIT nodeDeleted(nodeId);
@@ -492,6 +530,16 @@ void DataFlowGraphModel::loadNode(QJsonObject const &nodeJson)
                     onOutPortDataUpdated(restoredNodeId, portIndex);
                 });
 
+        connect(model.get(),
+                &NodeDelegateModel::embeddedWidgetSizeUpdated,
+                this,
+                [restoredNodeId, this]() { Q_EMIT nodeUpdated(restoredNodeId); });
+
+        connect(model.get(),
+                &NodeDelegateModel::nodeStyleUpdated,
+                this,
+                [restoredNodeId, this]() { Q_EMIT nodeUpdated(restoredNodeId); });
+
         _models[restoredNodeId] = std::move(model);
 
         Q_EMIT nodeCreated(restoredNodeId);
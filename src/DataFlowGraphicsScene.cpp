@@ -4,13 +4,13 @@
 #include "GraphicsView.hpp"
 #include "NodeDelegateModelRegistry.hpp"
 #include "NodeGraphicsObject.hpp"
+#include "NodePaletteModel.hpp"
 #include "UndoCommands.hpp"
 
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QGraphicsSceneMoveEvent>
-#include <QtWidgets/QHeaderView>
 #include <QtWidgets/QLineEdit>
-#include <QtWidgets/QTreeWidget>
+#include <QtWidgets/QListView>
 #include <QtWidgets/QWidgetAction>
 
 #include <QtCore/QBuffer>
@@ -34,9 +34,14 @@ DataFlowGraphicsScene::DataFlowGraphicsScene(DataFlowGraphModel &graphModel, QOb
 {
     connect(&_graphModel,
             &DataFlowGraphModel::inPortDataWasSet,
-            [this](NodeId const nodeId, PortType const, PortIndex const) { onNodeUpdated(nodeId); });
+            [this](NodeId const nodeId, PortType const, PortIndex const) {
+                // New data changes what the node shows, not its ports or caption.
+                onNodeContentUpdated(nodeId);
+            });
 }
 
+DataFlowGraphicsScene::~DataFlowGraphicsScene() = default;
+
 // TODO constructor for an empyt scene?
 
 std::vector<NodeId> DataFlowGraphicsScene::selectedNodes() const
@@ -72,66 +77,54 @@ QMenu *DataFlowGraphicsScene::createSceneMenu(QPointF const scenePos)
     // 1.
     modelMenu->addAction(txtBoxAction);
 
-    // Add result treeview to the context menu
-    QTreeWidget *treeView = new QTreeWidget(modelMenu);
-    treeView->header()->close();
+    // Add the model list to the context menu
+    if (!_paletteModel)
+        _paletteModel = std::make_unique<NodePaletteModel>();
 
-    auto *treeViewAction = new QWidgetAction(modelMenu);
-    treeViewAction->setDefaultWidget(treeView);
+    _paletteModel->update(*_graphModel.dataModelRegistry());
+    _paletteModel->setFilter(QString());
 
-    // 2.
-    modelMenu->addAction(treeViewAction);
+    auto *listView = new QListView(modelMenu);
+    listView->setModel(_paletteModel.get());
+    // Rows are laid out lazily; only the visible ones are measured and painted.
+    listView->setUniformItemSizes(true);
+    listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
 
-    auto registry = _graphModel.dataModelRegistry();
+    auto *listViewAction = new QWidgetAction(modelMenu);
+    listViewAction->setDefaultWidget(listView);
 
-    for (auto const &cat : registry->categories()) {
-        auto item = new QTreeWidgetItem(treeView);
-        item->setText(0, cat);
-        item->setFlags(item->flags() & ~Qt::ItemIsSelectable);
-    }
+    // 2.
+    modelMenu->addAction(listViewAction);
 
-    for (auto const &assoc : registry->registeredModelsCategoryAssociation()) {
-        QList<QTreeWidgetItem *> parent = treeView->findItems(assoc.second, Qt::MatchExactly);
+    auto createNode = [this, modelMenu, scenePos](QModelIndex const &index) {
+        QString const modelName = index.data(NodePaletteModel::ModelNameRole).toString();
 
-        if (parent.count() <= 0)
-            continue;
+        if (modelName.isEmpty())
+            return;
 
-        auto item = new QTreeWidgetItem(parent.first());
-        item->setText(0, assoc.first);
-    }
+        this->undoStack().push(new CreateCommand(this, modelName, scenePos));
 
-    treeView->expandAll();
+        modelMenu->close();
+    };
 
-    connect(treeView,
-            &QTreeWidget::itemClicked,
-            [this, modelMenu, scenePos](QTreeWidgetItem *item, int) {
-                if (!(item->flags() & (Qt::ItemIsSelectable))) {
-                    return;
-                }
+    connect(listView, &QListView::clicked, createNode);
 
-                this->undoStack().push(new CreateCommand(this, item->text(0), scenePos));
+    //Setup filtering
+    NodePaletteModel *paletteModel = _paletteModel.get();
 
-                modelMenu->close();
-            });
+    connect(txtBox, &QLineEdit::textChanged, [paletteModel](QString const &text) {
+        paletteModel->setFilter(text);
+    });
 
-    //Setup filtering
-    connect(txtBox, &QLineEdit::textChanged, [treeView](const QString &text) {
-        QTreeWidgetItemIterator categoryIt(treeView, QTreeWidgetItemIterator::HasChildren);
-        while (*categoryIt)
-            (*categoryIt++)->setHidden(true);
-        QTreeWidgetItemIterator it(treeView, QTreeWidgetItemIterator::NoChildren);
-        while (*it) {
-            auto modelName = (*it)->text(0);
-            const bool match = (modelName.contains(text, Qt::CaseInsensitive));
-            (*it)->setHidden(!match);
-            if (match) {
-                QTreeWidgetItem *parent = (*it)->parent();
-                while (parent) {
-                    parent->setHidden(false);
-                    parent = parent->parent();
-                }
+    // Enter creates the best match
+    connect(txtBox, &QLineEdit::returnPressed, [paletteModel, createNode]() {
+        for (int row = 0; row < paletteModel->rowCount(); ++row) {
+            QModelIndex const index = paletteModel->index(row);
+
+            if (index.flags() & Qt::ItemIsSelectable) {
+                createNode(index);
+                return;
             }
-            ++it;
         }
     });
 
@@ -183,7 +176,12 @@ bool DataFlowGraphicsScene::load()
 
     QByteArray const wholeFile = file.readAll();
 
-    _graphModel.load(QJsonDocument::fromJson(wholeFile).object());
+    // Graphics objects are created for the loaded graph as a whole, not per
+    // node, and in slices when incremental population is enabled.
+    {
+        PopulationSuspender suspender(*this);
+        _graphModel.load(QJsonDocument::fromJson(wholeFile).object());
+    }
 
     Q_EMIT sceneLoaded();
 
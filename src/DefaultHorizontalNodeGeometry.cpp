@@ -2,13 +2,36 @@
 
 #include "AbstractGraphModel.hpp"
 #include "NodeData.hpp"
+#include "PaintCounters.hpp"
 
 #include <QPoint>
 #include <QRect>
 #include <QWidget>
 
+#include <algorithm>
+
 namespace QtNodes {
 
+namespace {
+
+int side(PortType const portType)
+{
+    return (portType == PortType::Out) ? 1 : 0;
+}
+
+QString portCaption(AbstractGraphModel const &model,
+                    NodeId const nodeId,
+                    PortType const portType,
+                    PortIndex const portIndex)
+{
+    if (model.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible))
+        return model.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
+
+    return model.portData<NodeDataType>(nodeId, portType, portIndex, PortRole::DataType).name;
+}
+
+} // namespace
+
 DefaultHorizontalNodeGeometry::DefaultHorizontalNodeGeometry(AbstractGraphModel &graphModel)
     : AbstractNodeGeometry(graphModel)
     , _portSize(20)
@@ -30,26 +53,32 @@ QSize DefaultHorizontalNodeGeometry::size(NodeId const nodeId) const
 
 void DefaultHorizontalNodeGeometry::recomputeSize(NodeId const nodeId) const
 {
+    PaintCounters::add(PaintCounters::RecomputeSizeCalls);
+
+    NodeLayout &l = measure(nodeId);
+
     unsigned int height = maxVerticalPortsExtent(nodeId);
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
-        height = std::max(height, static_cast<unsigned int>(w->height()));
+    QSize const widgetSize = embeddedWidgetSize(nodeId);
+
+    if (widgetSize.isValid()) {
+        height = std::max(height, static_cast<unsigned int>(widgetSize.height()));
     }
 
-    QRectF const capRect = captionRect(nodeId);
+    QRectF const capRect = l.captionRect;
 
     height += capRect.height();
 
     height += _portSpasing; // space above caption
     height += _portSpasing; // space below caption
 
-    unsigned int inPortWidth = maxPortsTextAdvance(nodeId, PortType::In);
-    unsigned int outPortWidth = maxPortsTextAdvance(nodeId, PortType::Out);
+    unsigned int inPortWidth = l.maxPortsTextAdvance[side(PortType::In)];
+    unsigned int outPortWidth = l.maxPortsTextAdvance[side(PortType::Out)];
 
     unsigned int width = inPortWidth + outPortWidth + 4 * _portSpasing;
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
-        width += w->width();
+    if (widgetSize.isValid()) {
+        width += widgetSize.width();
     }
 
     width = std::max(width, static_cast<unsigned int>(capRect.width()) + 2 * _portSpasing);
@@ -57,111 +86,49 @@ void DefaultHorizontalNodeGeometry::recomputeSize(NodeId const nodeId) const
     QSize size(width, height);
 
     _graphModel.setNodeData(nodeId, NodeRole::Size, size);
+
+    l.size = size;
+    place(nodeId, l);
 }
 
 QPointF DefaultHorizontalNodeGeometry::portPosition(NodeId const nodeId,
                                                     PortType const portType,
                                                     PortIndex const portIndex) const
 {
-    unsigned int const step = _portSize + _portSpasing;
+    if (portType == PortType::None)
+        return QPointF();
 
-    QPointF result;
+    auto const &positions = portLayout(nodeId, portType, portIndex).portPositions[side(portType)];
 
-    double totalHeight = 0.0;
-
-    totalHeight += captionRect(nodeId).height();
-    totalHeight += _portSpasing;
-
-    totalHeight += step * portIndex;
-    totalHeight += step / 2.0;
-
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    switch (portType) {
-    case PortType::In: {
-        double x = 0.0;
-
-        result = QPointF(x, totalHeight);
-        break;
-    }
-
-    case PortType::Out: {
-        double x = size.width();
-
-        result = QPointF(x, totalHeight);
-        break;
-    }
-
-    default:
-        break;
-    }
-
-    return result;
+    return (portIndex < positions.size()) ? positions[portIndex] : QPointF();
 }
 
 QPointF DefaultHorizontalNodeGeometry::portTextPosition(NodeId const nodeId,
                                                         PortType const portType,
                                                         PortIndex const portIndex) const
 {
-    QPointF p = portPosition(nodeId, portType, portIndex);
-
-    QRectF rect = portTextRect(nodeId, portType, portIndex);
+    if (portType == PortType::None)
+        return QPointF();
 
-    p.setY(p.y() + rect.height() / 4.0);
+    auto const &positions
+        = portLayout(nodeId, portType, portIndex).portTextPositions[side(portType)];
 
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    switch (portType) {
-    case PortType::In:
-        p.setX(_portSpasing);
-        break;
-
-    case PortType::Out:
-        p.setX(size.width() - _portSpasing - rect.width());
-        break;
-
-    default:
-        break;
-    }
-
-    return p;
+    return (portIndex < positions.size()) ? positions[portIndex] : QPointF();
 }
 
 QRectF DefaultHorizontalNodeGeometry::captionRect(NodeId const nodeId) const
 {
-    if (!_graphModel.nodeData<bool>(nodeId, NodeRole::CaptionVisible))
-        return QRect();
-
-    QString name = _graphModel.nodeData<QString>(nodeId, NodeRole::Caption);
-
-    return _boldFontMetrics.boundingRect(name);
+    return layout(nodeId).captionRect;
 }
 
 QPointF DefaultHorizontalNodeGeometry::captionPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-    return QPointF(0.5 * (size.width() - captionRect(nodeId).width()),
-                   0.5 * _portSpasing + captionRect(nodeId).height());
+    return layout(nodeId).captionPosition;
 }
 
 QPointF DefaultHorizontalNodeGeometry::widgetPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    unsigned int captionHeight = captionRect(nodeId).height();
-
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
-        // If the widget wants to use as much vertical space as possible,
-        // place it immediately after the caption.
-        if (w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag) {
-            return QPointF(2.0 * _portSpasing + maxPortsTextAdvance(nodeId, PortType::In),
-                           captionHeight);
-        } else {
-            return QPointF(2.0 * _portSpasing + maxPortsTextAdvance(nodeId, PortType::In),
-                           (captionHeight + size.height() - w->height()) / 2.0);
-        }
-    }
-    return QPointF();
+    return layout(nodeId).widgetPosition;
 }
 
 QRect DefaultHorizontalNodeGeometry::resizeHandleRect(NodeId const nodeId) const
@@ -173,27 +140,42 @@ QRect DefaultHorizontalNodeGeometry::resizeHandleRect(NodeId const nodeId) const
     return QRect(size.width() - _portSpasing, size.height() - _portSpasing, rectSize, rectSize);
 }
 
+void DefaultHorizontalNodeGeometry::invalidateCache(NodeId const nodeId) const
+{
+    _layoutCache.erase(nodeId);
+}
+
+void DefaultHorizontalNodeGeometry::setFont(QFont const &font)
+{
+    _fontMetrics = QFontMetrics(font);
+
+    QFont f = font;
+    f.setBold(true);
+    _boldFontMetrics = QFontMetrics(f);
+
+    _portSize = _fontMetrics.height();
+
+    _layoutCache.clear();
+}
+
 QRectF DefaultHorizontalNodeGeometry::portTextRect(NodeId const nodeId,
                                                    PortType const portType,
                                                    PortIndex const portIndex) const
 {
-    QString s;
-    if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-        s = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-    } else {
-        auto portData = _graphModel.portData(nodeId, portType, portIndex, PortRole::DataType);
+    if (portType == PortType::None)
+        return QRectF();
 
-        s = portData.value<NodeDataType>().name;
-    }
+    auto const &rects = portLayout(nodeId, portType, portIndex).portTextRects[side(portType)];
 
-    return _fontMetrics.boundingRect(s);
+    return (portIndex < rects.size()) ? rects[portIndex] : QRectF();
 }
 
 unsigned int DefaultHorizontalNodeGeometry::maxVerticalPortsExtent(NodeId const nodeId) const
 {
-    PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
+    NodeLayout const &l = layout(nodeId);
 
-    PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+    std::size_t const nInPorts = l.portTextRects[side(PortType::In)].size();
+    std::size_t const nOutPorts = l.portTextRects[side(PortType::Out)].size();
 
     unsigned int maxNumOfEntries = std::max(nInPorts, nOutPorts);
     unsigned int step = _portSize + _portSpasing;
@@ -204,36 +186,142 @@ unsigned int DefaultHorizontalNodeGeometry::maxVerticalPortsExtent(NodeId const
 unsigned int DefaultHorizontalNodeGeometry::maxPortsTextAdvance(NodeId const nodeId,
                                                                 PortType const portType) const
 {
-    unsigned int width = 0;
+    if (portType == PortType::None)
+        return 0;
 
-    size_t const n = _graphModel
-                         .nodeData(nodeId,
-                                   (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                               : NodeRole::InPortCount)
-                         .toUInt();
+    return layout(nodeId).maxPortsTextAdvance[side(portType)];
+}
 
-    for (PortIndex portIndex = 0ul; portIndex < n; ++portIndex) {
-        QString name;
+DefaultHorizontalNodeGeometry::NodeLayout const &DefaultHorizontalNodeGeometry::layout(
+    NodeId const nodeId) const
+{
+    auto it = _layoutCache.find(nodeId);
+    if (it != _layoutCache.end())
+        return it->second;
 
-        if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-            name = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-        } else {
-            NodeDataType portData = _graphModel.portData<NodeDataType>(nodeId,
-                                                                       portType,
-                                                                       portIndex,
-                                                                       PortRole::DataType);
+    NodeLayout &l = measure(nodeId);
 
-            name = portData.name;
-        }
+    l.size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    place(nodeId, l);
+
+    return l;
+}
+
+DefaultHorizontalNodeGeometry::NodeLayout const &DefaultHorizontalNodeGeometry::portLayout(
+    NodeId const nodeId, PortType const portType, PortIndex const portIndex) const
+{
+    NodeLayout const &l = layout(nodeId);
+
+    if (portIndex < l.portPositions[side(portType)].size())
+        return l;
+
+    _layoutCache.erase(nodeId);
+
+    return layout(nodeId);
+}
+
+DefaultHorizontalNodeGeometry::NodeLayout &DefaultHorizontalNodeGeometry::measure(
+    NodeId const nodeId) const
+{
+    NodeLayout &l = _layoutCache[nodeId];
+    l = NodeLayout();
+
+    if (_graphModel.nodeData<bool>(nodeId, NodeRole::CaptionVisible)) {
+        QString name = _graphModel.nodeData<QString>(nodeId, NodeRole::Caption);
+
+        l.captionRect = _boldFontMetrics.boundingRect(name);
+    }
+
+    for (PortType portType : {PortType::In, PortType::Out}) {
+        int const i = side(portType);
+
+        PortCount const n = _graphModel.nodeData<PortCount>(nodeId,
+                                                            (portType == PortType::Out)
+                                                                ? NodeRole::OutPortCount
+                                                                : NodeRole::InPortCount);
+
+        l.portTextRects[i].reserve(n);
+
+        for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
+            QString const name = portCaption(_graphModel, nodeId, portType, portIndex);
+
+            l.portTextRects[i].push_back(_fontMetrics.boundingRect(name));
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        width = std::max(unsigned(_fontMetrics.horizontalAdvance(name)), width);
+            unsigned int const advance = _fontMetrics.horizontalAdvance(name);
 #else
-        width = std::max(unsigned(_fontMetrics.width(name)), width);
+            unsigned int const advance = _fontMetrics.width(name);
 #endif
+            l.maxPortsTextAdvance[i] = std::max(advance, l.maxPortsTextAdvance[i]);
+        }
+    }
+
+    return l;
+}
+
+void DefaultHorizontalNodeGeometry::place(NodeId const nodeId, NodeLayout &l) const
+{
+    unsigned int const step = _portSize + _portSpasing;
+
+    for (PortType portType : {PortType::In, PortType::Out}) {
+        int const i = side(portType);
+
+        std::size_t const n = l.portTextRects[i].size();
+
+        l.portPositions[i].resize(n);
+        l.portTextPositions[i].resize(n);
+
+        for (std::size_t portIndex = 0; portIndex < n; ++portIndex) {
+            double totalHeight = 0.0;
+
+            totalHeight += l.captionRect.height();
+            totalHeight += _portSpasing;
+
+            totalHeight += step * portIndex;
+            totalHeight += step / 2.0;
+
+            double const x = (portType == PortType::Out) ? l.size.width() : 0.0;
+
+            QPointF const position(x, totalHeight);
+
+            l.portPositions[i][portIndex] = position;
+
+            QRectF const &rect = l.portTextRects[i][portIndex];
+
+            QPointF p = position;
+
+            p.setY(p.y() + rect.height() / 4.0);
+
+            if (portType == PortType::In)
+                p.setX(_portSpasing);
+            else
+                p.setX(l.size.width() - _portSpasing - rect.width());
+
+            l.portTextPositions[i][portIndex] = p;
+        }
     }
 
-    return width;
+    l.captionPosition = QPointF(0.5 * (l.size.width() - l.captionRect.width()),
+                                0.5 * _portSpasing + l.captionRect.height());
+
+    l.widgetPosition = QPointF();
+
+    unsigned int captionHeight = l.captionRect.height();
+
+    QWidget *w = nullptr;
+    QSize const widgetSize = embeddedWidgetSize(nodeId, &w);
+
+    if (widgetSize.isValid()) {
+        double const x = 2.0 * _portSpasing + l.maxPortsTextAdvance[side(PortType::In)];
+
+        // If the widget wants to use as much vertical space as possible,
+        // place it immediately after the caption.
+        if (w && (w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag)) {
+            l.widgetPosition = QPointF(x, captionHeight);
+        } else {
+            l.widgetPosition = QPointF(x, (captionHeight + l.size.height() - widgetSize.height()) / 2.0);
+        }
+    }
 }
 
 } // namespace QtNodes
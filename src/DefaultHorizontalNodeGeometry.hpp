@@ -4,6 +4,9 @@
 
 #include <QtGui/QFontMetrics>
 
+#include <unordered_map>
+#include <vector>
+
 namespace QtNodes {
 
 class AbstractGraphModel;
@@ -34,6 +37,10 @@ public:
 
     QRect resizeHandleRect(NodeId const nodeId) const override;
 
+    void invalidateCache(NodeId const nodeId) const override;
+
+    void setFont(QFont const &font) override;
+
 private:
     QRectF portTextRect(NodeId const nodeId,
                         PortType const portType,
@@ -53,6 +60,40 @@ private:
     unsigned int _portSpasing;
     mutable QFontMetrics _fontMetrics;
     mutable QFontMetrics _boldFontMetrics;
+
+private:
+    /// Layout of one node. Built by recomputeSize() or on first use, dropped
+    /// by invalidateCache() and on font changes.
+    struct NodeLayout
+    {
+        QSize size;
+        QRectF captionRect;
+        QPointF captionPosition;
+        QPointF widgetPosition;
+
+        // Indexed by PortType::In and PortType::Out.
+        unsigned int maxPortsTextAdvance[2] = {0, 0};
+        std::vector<QRectF> portTextRects[2];
+        std::vector<QPointF> portPositions[2];
+        std::vector<QPointF> portTextPositions[2];
+    };
+
+    /// Cached layout, rebuilt on a miss.
+    NodeLayout const &layout(NodeId const nodeId) const;
+
+    /// Like layout(), but rebuilds when the port is not in the cached layout,
+    /// e.g. between port insertion and the following `nodeUpdated`.
+    NodeLayout const &portLayout(NodeId const nodeId,
+                                 PortType const portType,
+                                 PortIndex const portIndex) const;
+
+    /// Fills the size independent part of the layout: text metrics and port counts.
+    NodeLayout &measure(NodeId const nodeId) const;
+
+    /// Fills the positions of a measured layout for `layout.size`.
+    void place(NodeId const nodeId, NodeLayout &layout) const;
+
+    mutable std::unordered_map<NodeId, NodeLayout> _layoutCache;
 };
 
 } // namespace QtNodes
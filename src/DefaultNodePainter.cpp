@@ -1,6 +1,13 @@
 
 #include <cmath>
 #include <QtCore/QMargins>
+#include <QtCore/QMutex>
+#include <QtGui/QImage>
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <vector>
 
 #include "DefaultNodePainter.hpp"
 
@@ -15,12 +22,146 @@
 
 namespace QtNodes {
 
+namespace {
+
+// Same parameters as the QGraphicsDropShadowEffect formerly set on each node.
+int const ShadowBlurRadius = 20;
+QPointF const ShadowOffset(4.0, 4.0);
+
+double const NodeCornerRadius = 3.0;
+
+// Nodes narrower than the 9-slice minimum get their own image, with the
+// size rounded down to this step to keep the cache small.
+int const ShadowSizeStep = 8;
+
+/// One box blur pass over `count` bytes spaced by `step`. Pixels outside
+/// the line count as transparent.
+void boxBlurLine(uchar *line, int count, int step, int radius, std::vector<int> &buffer)
+{
+    buffer.resize(count);
+
+    for (int i = 0; i < count; ++i)
+        buffer[i] = line[i * step];
+
+    int const window = 2 * radius + 1;
+
+    int sum = 0;
+    for (int i = 0; i <= radius && i < count; ++i)
+        sum += buffer[i];
+
+    for (int i = 0; i < count; ++i) {
+        line[i * step] = uchar(sum / window);
+
+        if (i + radius + 1 < count)
+            sum += buffer[i + radius + 1];
+
+        if (i - radius >= 0)
+            sum -= buffer[i - radius];
+    }
+}
+
+/// Blurred rounded rect of size `inner` with a transparent border of `radius`.
+QImage renderShadow(QSize const &inner, int radius, QColor const &color)
+{
+    QImage alpha(inner.width() + 2 * radius, inner.height() + 2 * radius, QImage::Format_Alpha8);
+    alpha.fill(0);
+
+    {
+        QPainter p(&alpha);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.setPen(Qt::NoPen);
+        p.setBrush(Qt::black);
+        p.drawRoundedRect(QRectF(radius, radius, inner.width(), inner.height()),
+                          NodeCornerRadius,
+                          NodeCornerRadius);
+    }
+
+    // Three box passes approximate a gaussian that fades out within `radius`.
+    int const box = std::max(1, radius / 3);
+
+    std::vector<int> buffer;
+
+    for (int pass = 0; pass < 3; ++pass) {
+        for (int y = 0; y < alpha.height(); ++y)
+            boxBlurLine(alpha.scanLine(y), alpha.width(), 1, box, buffer);
+
+        uchar *bits = alpha.bits();
+        for (int x = 0; x < alpha.width(); ++x)
+            boxBlurLine(bits + x, alpha.height(), alpha.bytesPerLine(), box, buffer);
+    }
+
+    QImage shadow(alpha.size(), QImage::Format_ARGB32_Premultiplied);
+    shadow.fill(color);
+
+    QPainter p(&shadow);
+    p.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+    p.drawImage(0, 0, alpha);
+
+    return shadow;
+}
+
+/// Shared across painters and threads; QImage, unlike QPixmap, may be used
+/// outside the GUI thread.
+QImage cachedShadow(QSize const &inner, int radius, QColor const &color)
+{
+    using Key = std::tuple<int, int, int, QRgb>;
+
+    static QMutex mutex;
+    static std::map<Key, QImage> cache;
+
+    Key const key(inner.width(), inner.height(), radius, color.rgba());
+
+    QMutexLocker locker(&mutex);
+
+    auto it = cache.find(key);
+    if (it != cache.end())
+        return it->second;
+
+    // A handful of style colors is the norm; this only bounds pathological use.
+    std::size_t const maxCacheSize = 64;
+    if (cache.size() >= maxCacheSize)
+        cache.clear();
+
+    QImage shadow = renderShadow(inner, radius, color);
+    cache.emplace(key, shadow);
+
+    return shadow;
+}
+
+/// Draws `image` into `target`, stretching only the two center rows and columns.
+void drawNineSlice(QPainter *painter, QRectF const &target, QImage const &image)
+{
+    int const sx = image.width() / 2 - 1;
+    int const sy = image.height() / 2 - 1;
+
+    int const ix[4] = {0, sx, image.width() - sx, image.width()};
+    int const iy[4] = {0, sy, image.height() - sy, image.height()};
+
+    double const tx[4] = {target.left(), target.left() + sx, target.right() - sx, target.right()};
+    double const ty[4] = {target.top(), target.top() + sy, target.bottom() - sy, target.bottom()};
+
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            QRectF const source(ix[i], iy[j], ix[i + 1] - ix[i], iy[j + 1] - iy[j]);
+            QRectF const dest(tx[i], ty[j], tx[i + 1] - tx[i], ty[j + 1] - ty[j]);
+
+            if (!dest.isEmpty())
+                painter->drawImage(dest, image, source);
+        }
+    }
+}
+
+} // namespace
+
 void DefaultNodePainter::paint(QPainter *painter, NodeGraphicsObject &ngo) const
 {
     // TODO?
     //AbstractNodeGeometry & geometry = ngo.nodeScene()->nodeGeometry();
     //geometry.recomputeSizeIfFontChanged(painter->font());
 
+    if (!ngo.nodeScene()->nodeShadowEffectEnabled())
+        drawNodeShadow(painter, ngo);
+
     drawNodeRect(painter, ngo);
 
     drawConnectionPoints(painter, ngo);
@@ -34,19 +175,76 @@ void DefaultNodePainter::paint(QPainter *painter, NodeGraphicsObject &ngo) const
     drawResizeRect(painter, ngo);
 }
 
-void DefaultNodePainter::drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo) const
+void DefaultNodePainter::paintWithDetail(QPainter *painter,
+                                         NodeGraphicsObject &ngo,
+                                         LevelOfDetail lod) const
 {
-    AbstractGraphModel &model = ngo.graphModel();
+    switch (lod) {
+    case LevelOfDetail::Minimal:
+        drawFlatNodeRect(painter, ngo, false);
+        break;
+
+    case LevelOfDetail::Simplified:
+        drawFlatNodeRect(painter, ngo, true);
+        drawFilledConnectionPoints(painter, ngo);
+        break;
+
+    case LevelOfDetail::Full:
+        paint(painter, ngo);
+        return;
+    }
+
+    // The port reaction is consumed by drawConnectionPoints at full detail.
+    if (ngo.nodeState().connectionForReaction()) {
+        ngo.nodeState().resetConnectionForReaction();
+    }
+}
+
+QMarginsF DefaultNodePainter::paintMargins(NodeGraphicsObject const &ngo) const
+{
+    if (ngo.nodeScene()->nodeShadowEffectEnabled())
+        return QMarginsF();
+
+    double const r = ShadowBlurRadius;
+
+    return QMarginsF(r - ShadowOffset.x(),
+                     r - ShadowOffset.y(),
+                     r + ShadowOffset.x(),
+                     r + ShadowOffset.y());
+}
+
+void DefaultNodePainter::drawNodeShadow(QPainter *painter, NodeGraphicsObject &ngo) const
+{
+    QSize const size = ngo.nodeScene()->nodeGeometry().size(ngo.nodeId());
+
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
+
+    // Past twice the radius the center of the blurred image is uniform and
+    // a single image stretches to any node size.
+    auto bucket = [](int extent) {
+        return std::min(extent / ShadowSizeStep * ShadowSizeStep, 2 * ShadowBlurRadius);
+    };
 
+    QImage const shadow = cachedShadow(QSize(bucket(size.width()), bucket(size.height())),
+                                       ShadowBlurRadius,
+                                       nodeStyle.ShadowColor);
+
+    double const r = ShadowBlurRadius;
+
+    QRectF const target = QRectF(QPointF(0, 0), size).adjusted(-r, -r, r, r).translated(ShadowOffset);
+
+    drawNineSlice(painter, target, shadow);
+}
+
+void DefaultNodePainter::drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo) const
+{
     NodeId const nodeId = ngo.nodeId();
 
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
     QSize size = geometry.size(nodeId);
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     auto color = ngo.isSelected() ? nodeStyle.SelectedBoundaryColor : nodeStyle.NormalBoundaryColor;
 
@@ -69,9 +267,35 @@ void DefaultNodePainter::drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo
 
     QRectF boundary(0, 0, size.width(), size.height());
 
-    double const radius = 3.0;
+    painter->drawRoundedRect(boundary, NodeCornerRadius, NodeCornerRadius);
+}
+
+void DefaultNodePainter::drawFlatNodeRect(QPainter *painter,
+                                          NodeGraphicsObject &ngo,
+                                          bool withBoundary) const
+{
+    NodeId const nodeId = ngo.nodeId();
+    AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
+
+    QSize size = geometry.size(nodeId);
+
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
+
+    QRectF boundary(0, 0, size.width(), size.height());
+
+    if (withBoundary) {
+        auto color = ngo.isSelected() ? nodeStyle.SelectedBoundaryColor
+                                      : nodeStyle.NormalBoundaryColor;
+        painter->setPen(QPen(color, nodeStyle.PenWidth));
+        painter->setBrush(nodeStyle.GradientColor1);
+    } else {
+        // Too small for an outline to be visible; the fill alone carries the selection.
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(ngo.isSelected() ? nodeStyle.SelectedBoundaryColor
+                                           : nodeStyle.GradientColor1);
+    }
 
-    painter->drawRoundedRect(boundary, radius, radius);
+    painter->drawRect(boundary);
 }
 
 void DefaultNodePainter::drawConnectionPoints(QPainter *painter, NodeGraphicsObject &ngo) const
@@ -80,8 +304,7 @@ void DefaultNodePainter::drawConnectionPoints(QPainter *painter, NodeGraphicsObj
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     auto const &connectionStyle = StyleCollection::connectionStyle();
 
@@ -149,8 +372,7 @@ void DefaultNodePainter::drawFilledConnectionPoints(QPainter *painter, NodeGraph
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     auto diameter = nodeStyle.ConnectionPointDiameter;
 
@@ -203,8 +425,7 @@ void DefaultNodePainter::drawNodeCaption(QPainter *painter, NodeGraphicsObject &
 
     QPointF position = geometry.captionPosition(nodeId); 
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object()); 
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     painter->setFont(f); 
     painter->setPen(nodeStyle.FontColor); 
@@ -221,8 +442,7 @@ void DefaultNodePainter::drawEntryLabels(QPainter *painter, NodeGraphicsObject &
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     for (PortType portType : {PortType::Out, PortType::In}) {
         unsigned int n = model.nodeData<unsigned int>(nodeId, (portType == PortType::Out)
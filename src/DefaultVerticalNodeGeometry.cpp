@@ -2,13 +2,36 @@
 
 #include "AbstractGraphModel.hpp"
 #include "NodeData.hpp"
+#include "PaintCounters.hpp"
 
 #include <QPoint>
 #include <QRect>
 #include <QWidget>
 
+#include <algorithm>
+
 namespace QtNodes {
 
+namespace {
+
+int side(PortType const portType)
+{
+    return (portType == PortType::Out) ? 1 : 0;
+}
+
+QString portCaption(AbstractGraphModel const &model,
+                    NodeId const nodeId,
+                    PortType const portType,
+                    PortIndex const portIndex)
+{
+    if (model.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible))
+        return model.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
+
+    return model.portData<NodeDataType>(nodeId, portType, portIndex, PortRole::DataType).name;
+}
+
+} // namespace
+
 DefaultVerticalNodeGeometry::DefaultVerticalNodeGeometry(AbstractGraphModel &graphModel)
     : AbstractNodeGeometry(graphModel)
     , _portSize(20)
@@ -30,29 +53,35 @@ QSize DefaultVerticalNodeGeometry::size(NodeId const nodeId) const
 
 void DefaultVerticalNodeGeometry::recomputeSize(NodeId const nodeId) const
 {
+    PaintCounters::add(PaintCounters::RecomputeSizeCalls);
+
+    NodeLayout &l = measure(nodeId);
+
     unsigned int height = _portSpasing; // maxHorizontalPortsExtent(nodeId);
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
-        height = std::max(height, static_cast<unsigned int>(w->height()));
+    QSize const widgetSize = embeddedWidgetSize(nodeId);
+
+    if (widgetSize.isValid()) {
+        height = std::max(height, static_cast<unsigned int>(widgetSize.height()));
     }
 
-    QRectF const capRect = captionRect(nodeId);
+    QRectF const capRect = l.captionRect;
 
     height += capRect.height();
 
     height += _portSpasing;
     height += _portSpasing;
 
-    PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
-    PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+    PortCount nInPorts = l.portTextRects[side(PortType::In)].size();
+    PortCount nOutPorts = l.portTextRects[side(PortType::Out)].size();
 
     // Adding double step (top and bottom) to reserve space for port captions.
 
     height += portCaptionsHeight(nodeId, PortType::In);
     height += portCaptionsHeight(nodeId, PortType::Out);
 
-    unsigned int inPortWidth = maxPortsTextAdvance(nodeId, PortType::In);
-    unsigned int outPortWidth = maxPortsTextAdvance(nodeId, PortType::Out);
+    unsigned int inPortWidth = l.maxPortsTextAdvance[side(PortType::In)];
+    unsigned int outPortWidth = l.maxPortsTextAdvance[side(PortType::Out)];
 
     unsigned int totalInPortsWidth = nInPorts > 0
                                          ? inPortWidth * nInPorts + _portSpasing * (nInPorts - 1)
@@ -64,8 +93,8 @@ void DefaultVerticalNodeGeometry::recomputeSize(NodeId const nodeId) const
 
     unsigned int width = std::max(totalInPortsWidth, totalOutPortsWidth);
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
-        width = std::max(width, static_cast<unsigned int>(w->width()));
+    if (widgetSize.isValid()) {
+        width = std::max(width, static_cast<unsigned int>(widgetSize.width()));
     }
 
     width = std::max(width, static_cast<unsigned int>(capRect.width()));
@@ -76,118 +105,49 @@ void DefaultVerticalNodeGeometry::recomputeSize(NodeId const nodeId) const
     QSize size(width, height);
 
     _graphModel.setNodeData(nodeId, NodeRole::Size, size);
+
+    l.size = size;
+    place(nodeId, l);
 }
 
 QPointF DefaultVerticalNodeGeometry::portPosition(NodeId const nodeId,
                                                   PortType const portType,
                                                   PortIndex const portIndex) const
 {
-    QPointF result;
-
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    switch (portType) {
-    case PortType::In: {
-        unsigned int inPortWidth = maxPortsTextAdvance(nodeId, PortType::In) + _portSpasing;
-
-        PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
-
-        double x = (size.width() - (nInPorts - 1) * inPortWidth) / 2.0 + portIndex * inPortWidth;
-
-        double y = 0.0;
-
-        result = QPointF(x, y);
-
-        break;
-    }
+    if (portType == PortType::None)
+        return QPointF();
 
-    case PortType::Out: {
-        unsigned int outPortWidth = maxPortsTextAdvance(nodeId, PortType::Out) + _portSpasing;
-        PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
-
-        double x = (size.width() - (nOutPorts - 1) * outPortWidth) / 2.0 + portIndex * outPortWidth;
-
-        double y = size.height();
-
-        result = QPointF(x, y);
-
-        break;
-    }
-
-    default:
-        break;
-    }
+    auto const &positions = portLayout(nodeId, portType, portIndex).portPositions[side(portType)];
 
-    return result;
+    return (portIndex < positions.size()) ? positions[portIndex] : QPointF();
 }
 
 QPointF DefaultVerticalNodeGeometry::portTextPosition(NodeId const nodeId,
                                                       PortType const portType,
                                                       PortIndex const portIndex) const
 {
-    QPointF p = portPosition(nodeId, portType, portIndex);
+    if (portType == PortType::None)
+        return QPointF();
 
-    QRectF rect = portTextRect(nodeId, portType, portIndex);
+    auto const &positions
+        = portLayout(nodeId, portType, portIndex).portTextPositions[side(portType)];
 
-    p.setX(p.x() - rect.width() / 2.0);
-
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    switch (portType) {
-    case PortType::In:
-        p.setY(5.0 + rect.height());
-        break;
-
-    case PortType::Out:
-        p.setY(size.height() - 5.0);
-        break;
-
-    default:
-        break;
-    }
-
-    return p;
+    return (portIndex < positions.size()) ? positions[portIndex] : QPointF();
 }
 
 QRectF DefaultVerticalNodeGeometry::captionRect(NodeId const nodeId) const
 {
-    if (!_graphModel.nodeData<bool>(nodeId, NodeRole::CaptionVisible))
-        return QRect();
-
-    QString name = _graphModel.nodeData<QString>(nodeId, NodeRole::Caption);
-
-    return _boldFontMetrics.boundingRect(name);
+    return layout(nodeId).captionRect;
 }
 
 QPointF DefaultVerticalNodeGeometry::captionPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    unsigned int step = portCaptionsHeight(nodeId, PortType::In);
-    step += _portSpasing;
-
-    auto rect = captionRect(nodeId);
-
-    return QPointF(0.5 * (size.width() - rect.width()), step + rect.height());
+    return layout(nodeId).captionPosition;
 }
 
 QPointF DefaultVerticalNodeGeometry::widgetPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    unsigned int captionHeight = captionRect(nodeId).height();
-
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
-        // If the widget wants to use as much vertical space as possible,
-        // place it immediately after the caption.
-        if (w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag) {
-            return QPointF(_portSpasing + maxPortsTextAdvance(nodeId, PortType::In), captionHeight);
-        } else {
-            return QPointF(_portSpasing + maxPortsTextAdvance(nodeId, PortType::In),
-                           (captionHeight + size.height() - w->height()) / 2.0);
-        }
-    }
-    return QPointF();
+    return layout(nodeId).widgetPosition;
 }
 
 QRect DefaultVerticalNodeGeometry::resizeHandleRect(NodeId const nodeId) const
@@ -199,27 +159,42 @@ QRect DefaultVerticalNodeGeometry::resizeHandleRect(NodeId const nodeId) const
     return QRect(size.width() - rectSize, size.height() - rectSize, rectSize, rectSize);
 }
 
+void DefaultVerticalNodeGeometry::invalidateCache(NodeId const nodeId) const
+{
+    _layoutCache.erase(nodeId);
+}
+
+void DefaultVerticalNodeGeometry::setFont(QFont const &font)
+{
+    _fontMetrics = QFontMetrics(font);
+
+    QFont f = font;
+    f.setBold(true);
+    _boldFontMetrics = QFontMetrics(f);
+
+    _portSize = _fontMetrics.height();
+
+    _layoutCache.clear();
+}
+
 QRectF DefaultVerticalNodeGeometry::portTextRect(NodeId const nodeId,
                                                  PortType const portType,
                                                  PortIndex const portIndex) const
 {
-    QString s;
-    if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-        s = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-    } else {
-        auto portData = _graphModel.portData(nodeId, portType, portIndex, PortRole::DataType);
+    if (portType == PortType::None)
+        return QRectF();
 
-        s = portData.value<NodeDataType>().name;
-    }
+    auto const &rects = portLayout(nodeId, portType, portIndex).portTextRects[side(portType)];
 
-    return _fontMetrics.boundingRect(s);
+    return (portIndex < rects.size()) ? rects[portIndex] : QRectF();
 }
 
 unsigned int DefaultVerticalNodeGeometry::maxHorizontalPortsExtent(NodeId const nodeId) const
 {
-    PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
+    NodeLayout const &l = layout(nodeId);
 
-    PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+    std::size_t const nInPorts = l.portTextRects[side(PortType::In)].size();
+    std::size_t const nOutPorts = l.portTextRects[side(PortType::Out)].size();
 
     unsigned int maxNumOfEntries = std::max(nInPorts, nOutPorts);
     unsigned int step = _portSize + _portSpasing;
@@ -230,71 +205,148 @@ unsigned int DefaultVerticalNodeGeometry::maxHorizontalPortsExtent(NodeId const
 unsigned int DefaultVerticalNodeGeometry::maxPortsTextAdvance(NodeId const nodeId,
                                                               PortType const portType) const
 {
-    unsigned int width = 0;
+    if (portType == PortType::None)
+        return 0;
 
-    size_t const n = _graphModel
-                         .nodeData(nodeId,
-                                   (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                               : NodeRole::InPortCount)
-                         .toUInt();
+    return layout(nodeId).maxPortsTextAdvance[side(portType)];
+}
 
-    for (PortIndex portIndex = 0ul; portIndex < n; ++portIndex) {
-        QString name;
+unsigned int DefaultVerticalNodeGeometry::portCaptionsHeight(NodeId const nodeId,
+                                                             PortType const portType) const
+{
+    if (portType == PortType::None)
+        return 0;
 
-        if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-            name = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-        } else {
-            NodeDataType portData = _graphModel.portData<NodeDataType>(nodeId,
-                                                                       portType,
-                                                                       portIndex,
-                                                                       PortRole::DataType);
+    return layout(nodeId).portCaptionVisible[side(portType)] ? _portSpasing : 0;
+}
 
-            name = portData.name;
-        }
+DefaultVerticalNodeGeometry::NodeLayout const &DefaultVerticalNodeGeometry::layout(
+    NodeId const nodeId) const
+{
+    auto it = _layoutCache.find(nodeId);
+    if (it != _layoutCache.end())
+        return it->second;
+
+    NodeLayout &l = measure(nodeId);
+
+    l.size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    place(nodeId, l);
+
+    return l;
+}
+
+DefaultVerticalNodeGeometry::NodeLayout const &DefaultVerticalNodeGeometry::portLayout(
+    NodeId const nodeId, PortType const portType, PortIndex const portIndex) const
+{
+    NodeLayout const &l = layout(nodeId);
+
+    if (portIndex < l.portPositions[side(portType)].size())
+        return l;
+
+    _layoutCache.erase(nodeId);
+
+    return layout(nodeId);
+}
+
+DefaultVerticalNodeGeometry::NodeLayout &DefaultVerticalNodeGeometry::measure(
+    NodeId const nodeId) const
+{
+    NodeLayout &l = _layoutCache[nodeId];
+    l = NodeLayout();
+
+    if (_graphModel.nodeData<bool>(nodeId, NodeRole::CaptionVisible)) {
+        QString name = _graphModel.nodeData<QString>(nodeId, NodeRole::Caption);
+
+        l.captionRect = _boldFontMetrics.boundingRect(name);
+    }
+
+    for (PortType portType : {PortType::In, PortType::Out}) {
+        int const i = side(portType);
+
+        PortCount const n = _graphModel.nodeData<PortCount>(nodeId,
+                                                            (portType == PortType::Out)
+                                                                ? NodeRole::OutPortCount
+                                                                : NodeRole::InPortCount);
+
+        l.portTextRects[i].reserve(n);
+
+        for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
+            if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible))
+                l.portCaptionVisible[i] = true;
+
+            QString const name = portCaption(_graphModel, nodeId, portType, portIndex);
+
+            l.portTextRects[i].push_back(_fontMetrics.boundingRect(name));
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        width = std::max(unsigned(_fontMetrics.horizontalAdvance(name)), width);
+            unsigned int const advance = _fontMetrics.horizontalAdvance(name);
 #else
-        width = std::max(unsigned(_fontMetrics.width(name)), width);
+            unsigned int const advance = _fontMetrics.width(name);
 #endif
+            l.maxPortsTextAdvance[i] = std::max(advance, l.maxPortsTextAdvance[i]);
+        }
     }
 
-    return width;
+    return l;
 }
 
-unsigned int DefaultVerticalNodeGeometry::portCaptionsHeight(NodeId const nodeId,
-                                                             PortType const portType) const
+void DefaultVerticalNodeGeometry::place(NodeId const nodeId, NodeLayout &l) const
 {
-    unsigned int h = 0;
-
-    switch (portType) {
-    case PortType::In: {
-        PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
-        for (PortIndex i = 0; i < nInPorts; ++i) {
-            if (_graphModel.portData<bool>(nodeId, PortType::In, i, PortRole::CaptionVisible)) {
-                h += _portSpasing;
-                break;
-            }
-        }
-        break;
-    }
+    for (PortType portType : {PortType::In, PortType::Out}) {
+        int const i = side(portType);
+
+        std::size_t const n = l.portTextRects[i].size();
+
+        l.portPositions[i].resize(n);
+        l.portTextPositions[i].resize(n);
+
+        unsigned int const portWidth = l.maxPortsTextAdvance[i] + _portSpasing;
+
+        for (std::size_t portIndex = 0; portIndex < n; ++portIndex) {
+            double const x = (l.size.width() - (double(n) - 1) * portWidth) / 2.0
+                             + portIndex * portWidth;
+
+            double const y = (portType == PortType::Out) ? l.size.height() : 0.0;
+
+            l.portPositions[i][portIndex] = QPointF(x, y);
 
-    case PortType::Out: {
-        PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
-        for (PortIndex i = 0; i < nOutPorts; ++i) {
-            if (_graphModel.portData<bool>(nodeId, PortType::Out, i, PortRole::CaptionVisible)) {
-                h += _portSpasing;
-                break;
-            }
+            QRectF const &rect = l.portTextRects[i][portIndex];
+
+            QPointF p(x - rect.width() / 2.0, 0.0);
+
+            if (portType == PortType::In)
+                p.setY(5.0 + rect.height());
+            else
+                p.setY(l.size.height() - 5.0);
+
+            l.portTextPositions[i][portIndex] = p;
         }
-        break;
     }
 
-    default:
-        break;
-    }
+    unsigned int step = l.portCaptionVisible[side(PortType::In)] ? _portSpasing : 0;
+    step += _portSpasing;
+
+    l.captionPosition = QPointF(0.5 * (l.size.width() - l.captionRect.width()),
+                                step + l.captionRect.height());
+
+    l.widgetPosition = QPointF();
+
+    unsigned int captionHeight = l.captionRect.height();
 
-    return h;
+    QWidget *w = nullptr;
+    QSize const widgetSize = embeddedWidgetSize(nodeId, &w);
+
+    if (widgetSize.isValid()) {
+        double const x = _portSpasing + l.maxPortsTextAdvance[side(PortType::In)];
+
+        // If the widget wants to use as much vertical space as possible,
+        // place it immediately after the caption.
+        if (w && (w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag)) {
+            l.widgetPosition = QPointF(x, captionHeight);
+        } else {
+            l.widgetPosition = QPointF(x, (captionHeight + l.size.height() - widgetSize.height()) / 2.0);
+        }
+    }
 }
 
 } // namespace QtNodes
@@ -3,6 +3,7 @@
 #include "BasicGraphicsScene.hpp"
 #include "ConnectionGraphicsObject.hpp"
 #include "NodeGraphicsObject.hpp"
+#include "PaintCounters.hpp"
 #include "StyleCollection.hpp"
 #include "UndoCommands.hpp"
 
@@ -12,19 +13,25 @@
 #include <QtGui/QPen>
 
 #include <QtWidgets/QMenu>
+#include <QtWidgets/QRubberBand>
 
 #include <QtCore/QDebug>
 #include <QtCore/QPointF>
 #include <QtCore/QRectF>
+#include <QtCore/QTimer>
 
 #include <QtOpenGL>
 #include <QtWidgets>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 using QtNodes::BasicGraphicsScene;
 using QtNodes::GraphicsView;
+using QtNodes::NodeId;
+using QtNodes::PaintCounters;
 
 GraphicsView::GraphicsView(QWidget *parent)
     : QGraphicsView(parent)
@@ -55,6 +62,13 @@ GraphicsView::GraphicsView(QWidget *parent)
     // re-calculation when expanding the all QGraphicsItems common rect.
     int maxSize = 32767;
     setSceneRect(-maxSize, -maxSize, (maxSize * 2), (maxSize * 2));
+
+    connect(this, &GraphicsView::scaleChanged, this, [this](double) {
+        updateLevelOfDetail();
+        updateVisibleSceneRect();
+    });
+
+    _frameClock.start();
 }
 
 GraphicsView::GraphicsView(BasicGraphicsScene *scene, QWidget *parent)
@@ -144,6 +158,9 @@ void GraphicsView::setScene(BasicGraphicsScene *scene)
     auto redoAction = scene->undoStack().createRedoAction(this, tr("&Redo"));
     redoAction->setShortcuts(QKeySequence::Redo);
     addAction(redoAction);
+
+    updateLevelOfDetail();
+    updateVisibleSceneRect();
 }
 
 void GraphicsView::centerScene()
@@ -155,12 +172,33 @@ void GraphicsView::centerScene()
 
         if (sceneRect.width() > this->rect().width() || sceneRect.height() > this->rect().height()) {
             fitInView(sceneRect, Qt::KeepAspectRatio);
+            updateLevelOfDetail();
         }
 
         centerOn(sceneRect.center());
+
+        updateVisibleSceneRect();
     }
 }
 
+void GraphicsView::centerOnNode(NodeId const nodeId)
+{
+    BasicGraphicsScene *scene = nodeScene();
+
+    if (!scene || !scene->graphModel().nodeExists(nodeId))
+        return;
+
+    centerOn(scene->nodeSceneRect(nodeId).center());
+
+    // Creates the node's graphics object in a virtualized scene.
+    updateVisibleSceneRect();
+
+    scene->clearSelection();
+
+    if (auto ngo = scene->nodeGraphicsObject(nodeId))
+        ngo->setSelected(true);
+}
+
 void GraphicsView::contextMenuEvent(QContextMenuEvent *event)
 {
     if (itemAt(event->pos())) {
@@ -297,7 +335,8 @@ void GraphicsView::keyPressEvent(QKeyEvent *event)
 {
     switch (event->key()) {
     case Qt::Key_Shift:
-        setDragMode(QGraphicsView::RubberBandDrag);
+        // Rubber band selection is handled here through the scene's spatial index.
+        setDragMode(QGraphicsView::NoDrag);
         break;
 
     default:
@@ -322,6 +361,28 @@ void GraphicsView::keyReleaseEvent(QKeyEvent *event)
 
 void GraphicsView::mousePressEvent(QMouseEvent *event)
 {
+    if (event->button() == Qt::LeftButton && (event->modifiers() & Qt::ShiftModifier)
+        && nodeScene() && !itemAt(event->pos())) {
+        _rubberBandBaseSelection.clear();
+
+        if (event->modifiers() & Qt::ControlModifier) {
+            for (QGraphicsItem *item : scene()->selectedItems())
+                _rubberBandBaseSelection.insert(item);
+        } else {
+            scene()->clearSelection();
+        }
+
+        if (!_rubberBand)
+            _rubberBand = new QRubberBand(QRubberBand::Rectangle, viewport());
+
+        _rubberBandOrigin = event->pos();
+        _rubberBand->setGeometry(QRect(_rubberBandOrigin, QSize()));
+        _rubberBand->show();
+
+        event->accept();
+        return;
+    }
+
     QGraphicsView::mousePressEvent(event);
     if (event->button() == Qt::LeftButton) {
         _clickPos = mapToScene(event->pos());
@@ -330,55 +391,200 @@ void GraphicsView::mousePressEvent(QMouseEvent *event)
 
 void GraphicsView::mouseMoveEvent(QMouseEvent *event)
 {
+    if (_rubberBand && _rubberBand->isVisible()) {
+        updateRubberBandSelection(event->pos());
+        event->accept();
+        return;
+    }
+
     QGraphicsView::mouseMoveEvent(event);
     if (scene()->mouseGrabberItem() == nullptr && event->buttons() == Qt::LeftButton) {
         // Make sure shift is not being pressed
         if ((event->modifiers() & Qt::ShiftModifier) == 0) {
             QPointF difference = _clickPos - mapToScene(event->pos());
             setSceneRect(sceneRect().translated(difference.x(), difference.y()));
+
+            updateVisibleSceneRect();
         }
     }
 }
 
+void GraphicsView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (_rubberBand && _rubberBand->isVisible() && event->button() == Qt::LeftButton) {
+        updateRubberBandSelection(event->pos());
+
+        _rubberBand->hide();
+        _rubberBandBaseSelection.clear();
+
+        event->accept();
+        return;
+    }
+
+    QGraphicsView::mouseReleaseEvent(event);
+}
+
+void GraphicsView::updateRubberBandSelection(QPoint const &viewPos)
+{
+    BasicGraphicsScene *scene = nodeScene();
+
+    if (!scene)
+        return;
+
+    QRect const bandRect = QRect(_rubberBandOrigin, viewPos).normalized();
+
+    _rubberBand->setGeometry(bandRect);
+
+    QPolygonF const scenePolygon = mapToScene(bandRect);
+    QRectF const sceneRect = scenePolygon.boundingRect();
+
+    QPainterPath selectionArea;
+    selectionArea.addPolygon(scenePolygon);
+    selectionArea.closeSubpath();
+
+    std::unordered_set<QGraphicsItem *> hits;
+
+    for (NodeId const nodeId : scene->nodesInRect(sceneRect)) {
+        NodeGraphicsObject *ngo = scene->nodeGraphicsObject(nodeId);
+
+        if (ngo && (ngo->flags() & QGraphicsItem::ItemIsSelectable))
+            hits.insert(ngo);
+    }
+
+    for (ConnectionId const &connectionId : scene->connectionsInRect(sceneRect)) {
+        ConnectionGraphicsObject *cgo = scene->connectionGraphicsObject(connectionId);
+
+        // Batched connections are tested against the batch's cached stroke;
+        // only hits get an object, which they need to be selected.
+        if (!cgo) {
+            if (scene->batchedConnectionIntersects(connectionId, selectionArea))
+                cgo = scene->materializeConnection(connectionId);
+
+            if (cgo)
+                hits.insert(cgo);
+
+            continue;
+        }
+
+        if (cgo->collidesWithPath(cgo->mapFromScene(selectionArea)))
+            hits.insert(cgo);
+    }
+
+    for (QGraphicsItem *item : scene->selectedItems()) {
+        if (hits.find(item) == hits.end()
+            && _rubberBandBaseSelection.find(item) == _rubberBandBaseSelection.end())
+            item->setSelected(false);
+    }
+
+    for (QGraphicsItem *item : hits)
+        item->setSelected(true);
+}
+
+namespace {
+
+double const FineGridStep = 15.0;
+double const CoarseGridStep = 150.0;
+
+// Fine lines closer than this (in device pixels) turn into a flat tint and
+// are not drawn.
+double const MinFineGridSpacing = 4.0;
+
+// Bound on the number of zoom levels kept in the tile cache.
+std::size_t const MaxGridTiles = 8;
+
+// Frames kept for the frame rate and frame time percentiles.
+std::size_t const MaxRecordedFrames = 120;
+
+static_assert(PaintCounters::CounterCount == 4,
+              "GraphicsView keeps one slot per paint counter");
+
+} // namespace
+
 void GraphicsView::drawBackground(QPainter *painter, const QRectF &r)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    drawGridBackground(painter, r);
+
+    _backgroundNanoseconds += timer.nsecsElapsed();
+}
+
+void GraphicsView::drawGridBackground(QPainter *painter, const QRectF &r)
 {
     QGraphicsView::drawBackground(painter, r);
 
-    auto drawGrid = [&](double gridStep) {
-        QRect windowRect = rect();
-        QPointF tl = mapToScene(windowRect.topLeft());
-        QPointF br = mapToScene(windowRect.bottomRight());
+    // The grid is drawn as a texture of one coarse cell rendered at device
+    // resolution, so a repaint is a single fill regardless of the zoom.
+    double const deviceScale = getScale() * devicePixelRatioF();
 
-        double left = std::floor(tl.x() / gridStep - 0.5);
-        double right = std::floor(br.x() / gridStep + 1.0);
-        double bottom = std::floor(tl.y() / gridStep - 0.5);
-        double top = std::floor(br.y() / gridStep + 1.0);
+    int const tileSize = qRound(CoarseGridStep * deviceScale);
 
-        // vertical lines
-        for (int xi = int(left); xi <= int(right); ++xi) {
-            QLineF line(xi * gridStep, bottom * gridStep, xi * gridStep, top * gridStep);
+    if (tileSize < 1)
+        return;
 
-            painter->drawLine(line);
-        }
+    bool const drawFine = FineGridStep * deviceScale >= MinFineGridSpacing;
 
-        // horizontal lines
-        for (int yi = int(bottom); yi <= int(top); ++yi) {
-            QLineF line(left * gridStep, yi * gridStep, right * gridStep, yi * gridStep);
-            painter->drawLine(line);
-        }
-    };
+    QBrush brush(gridTile(tileSize, drawFine));
+
+    // Maps one tile pixel to one device pixel and anchors the tiles at the
+    // scene origin, matching the line positions of the old per-line grid.
+    double const tileScale = CoarseGridStep / tileSize;
+    brush.setTransform(QTransform::fromScale(tileScale, tileScale));
 
+    painter->fillRect(r, brush);
+}
+
+QPixmap const &GraphicsView::gridTile(int tileSize, bool drawFine)
+{
     auto const &flowViewStyle = StyleCollection::flowViewStyle();
 
-    QPen pfine(flowViewStyle.FineGridColor, 1.0);
+    if (_gridTileFineColor != flowViewStyle.FineGridColor
+        || _gridTileCoarseColor != flowViewStyle.CoarseGridColor) {
+        _gridTiles.clear();
+        _gridTileFineColor = flowViewStyle.FineGridColor;
+        _gridTileCoarseColor = flowViewStyle.CoarseGridColor;
+    }
+
+    auto const key = std::make_pair(tileSize, drawFine);
 
-    painter->setPen(pfine);
-    drawGrid(15);
+    auto it = _gridTiles.find(key);
+
+    if (it != _gridTiles.end())
+        return it->second;
+
+    if (_gridTiles.size() >= MaxGridTiles)
+        _gridTiles.clear();
+
+    QPixmap tile(tileSize, tileSize);
+    tile.fill(Qt::transparent);
+
+    QPainter painter(&tile);
+    painter.setRenderHint(QPainter::Antialiasing, renderHints() & QPainter::Antialiasing);
+
+    // Same 1.0 scene unit pen width as the grid has always used.
+    double const penWidth = tileSize / CoarseGridStep;
+
+    // Lines on the tile border are drawn on both edges so that each tile
+    // contributes its half of the shared line.
+    auto drawLines = [&](double step) {
+        for (double pos = 0.0; pos <= tileSize + 0.5 * step; pos += step) {
+            painter.drawLine(QLineF(pos, 0.0, pos, tileSize));
+            painter.drawLine(QLineF(0.0, pos, tileSize, pos));
+        }
+    };
+
+    if (drawFine) {
+        painter.setPen(QPen(flowViewStyle.FineGridColor, penWidth));
+        drawLines(tileSize * FineGridStep / CoarseGridStep);
+    }
 
-    QPen p(flowViewStyle.CoarseGridColor, 1.0);
+    painter.setPen(QPen(flowViewStyle.CoarseGridColor, penWidth));
+    drawLines(tileSize);
 
-    painter->setPen(p);
-    drawGrid(150);
+    painter.end();
+
+    return _gridTiles.emplace(key, std::move(tile)).first->second;
 }
 
 void GraphicsView::showEvent(QShowEvent *event)
@@ -388,11 +594,216 @@ void GraphicsView::showEvent(QShowEvent *event)
     centerScene();
 }
 
+void GraphicsView::paintEvent(QPaintEvent *event)
+{
+    // The overlay's own periodic refresh is not a frame of the scene; counting
+    // it would report the refresh rate and dilute the frame times.
+    if (_statisticsOverlayEnabled
+        && event->region().subtracted(statisticsOverlayRect()).isEmpty()) {
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+
+    qint64 const start = _frameClock.nsecsElapsed();
+
+    _backgroundNanoseconds = 0;
+
+    // Paints happen inside this call, so they are attributed to this view.
+    _counterSnapshot[PaintCounters::NodePaints] = PaintCounters::value(PaintCounters::NodePaints);
+    _counterSnapshot[PaintCounters::ConnectionPaints] = PaintCounters::value(
+        PaintCounters::ConnectionPaints);
+
+    QGraphicsView::paintEvent(event);
+
+    double const frameTime = (_frameClock.nsecsElapsed() - start) / 1e6;
+
+    _frames.emplace_back(start, frameTime);
+
+    if (_frames.size() > MaxRecordedFrames)
+        _frames.pop_front();
+
+    // Paint counts cover this paint event; the layout counters cover the
+    // event handling since the previous frame, in any view.
+    for (int i = 0; i < PaintCounters::CounterCount; ++i) {
+        quint64 const value = PaintCounters::value(static_cast<PaintCounters::Counter>(i));
+
+        _frameCounters[i] = value - _counterSnapshot[i];
+        _counterSnapshot[i] = value;
+    }
+
+    _lastBackgroundNanoseconds = _backgroundNanoseconds;
+}
+
+GraphicsView::FrameStatistics GraphicsView::frameStatistics() const
+{
+    FrameStatistics result;
+
+    if (_frames.empty())
+        return result;
+
+    if (_frames.size() > 1) {
+        double const span = (_frames.back().first - _frames.front().first) / 1e9;
+
+        if (span > 0)
+            result.framesPerSecond = (_frames.size() - 1) / span;
+    }
+
+    std::vector<double> times;
+    times.reserve(_frames.size());
+
+    for (auto const &frame : _frames)
+        times.push_back(frame.second);
+
+    std::sort(times.begin(), times.end());
+
+    auto percentile = [&times](double p) {
+        return times[static_cast<std::size_t>(p * (times.size() - 1) + 0.5)];
+    };
+
+    result.frameTimeP50 = percentile(0.50);
+    result.frameTimeP90 = percentile(0.90);
+    result.frameTimeP99 = percentile(0.99);
+
+    result.backgroundTime = _lastBackgroundNanoseconds / 1e6;
+
+    result.nodePaints = _frameCounters[PaintCounters::NodePaints];
+    result.connectionPaints = _frameCounters[PaintCounters::ConnectionPaints];
+    result.recomputeSizeCalls = _frameCounters[PaintCounters::RecomputeSizeCalls];
+    result.moveConnectionsCalls = _frameCounters[PaintCounters::MoveConnectionsCalls];
+
+    return result;
+}
+
+void GraphicsView::setStatisticsOverlayEnabled(bool enabled)
+{
+    if (_statisticsOverlayEnabled == enabled)
+        return;
+
+    _statisticsOverlayEnabled = enabled;
+
+    if (!_statisticsOverlayTimer) {
+        _statisticsOverlayTimer = new QTimer(this);
+
+        // Refreshing the overlay on every frame would keep the view
+        // repainting and skew the numbers it shows.
+        _statisticsOverlayTimer->setInterval(500);
+
+        connect(_statisticsOverlayTimer, &QTimer::timeout, this, [this]() {
+            viewport()->update(statisticsOverlayRect());
+        });
+    }
+
+    if (enabled)
+        _statisticsOverlayTimer->start();
+    else
+        _statisticsOverlayTimer->stop();
+
+    viewport()->update(statisticsOverlayRect());
+}
+
+void GraphicsView::drawForeground(QPainter *painter, const QRectF &r)
+{
+    QGraphicsView::drawForeground(painter, r);
+
+    if (!_statisticsOverlayEnabled)
+        return;
+
+    FrameStatistics const s = frameStatistics();
+
+    QStringList lines;
+    lines << QString("%1 fps").arg(s.framesPerSecond, 0, 'f', 1)
+          << QString("frame p50/p90/p99: %1 / %2 / %3 ms")
+                 .arg(s.frameTimeP50, 0, 'f', 2)
+                 .arg(s.frameTimeP90, 0, 'f', 2)
+                 .arg(s.frameTimeP99, 0, 'f', 2)
+          << QString("background: %1 ms").arg(s.backgroundTime, 0, 'f', 2)
+          << QString("node paints: %1").arg(s.nodePaints)
+          << QString("connection paints: %1").arg(s.connectionPaints)
+          << QString("recomputeSize: %1").arg(s.recomputeSizeCalls)
+          << QString("moveConnections: %1").arg(s.moveConnectionsCalls);
+
+    painter->save();
+
+    // Drawn in viewport coordinates, independent of zoom and scroll.
+    painter->resetTransform();
+
+    QRect const overlay = statisticsOverlayRect();
+
+    painter->fillRect(overlay, QColor(0, 0, 0, 160));
+    painter->setPen(Qt::white);
+    painter->setFont(font());
+    painter->drawText(overlay.adjusted(6, 4, -6, -4),
+                      Qt::AlignLeft | Qt::AlignTop,
+                      lines.join('\n'));
+
+    painter->restore();
+}
+
+QRect GraphicsView::statisticsOverlayRect() const
+{
+    QFontMetrics const metrics(font());
+
+    // Wide enough for the longest line with three-digit frame times.
+    int const width = metrics.horizontalAdvance(
+        QStringLiteral("frame p50/p90/p99: 000.00 / 000.00 / 000.00 ms"));
+
+    return QRect(8, 8, width + 12, 7 * metrics.lineSpacing() + 8);
+}
+
+void GraphicsView::resizeEvent(QResizeEvent *event)
+{
+    QGraphicsView::resizeEvent(event);
+
+    updateVisibleSceneRect();
+}
+
+void GraphicsView::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+
+    // The scroll blits the overlay along with the scene; repaint both the
+    // copy and the overlay's fixed place.
+    if (_statisticsOverlayEnabled) {
+        QRect const overlay = statisticsOverlayRect();
+
+        viewport()->update(overlay);
+        viewport()->update(overlay.translated(dx, dy));
+    }
+
+    updateVisibleSceneRect();
+}
+
 BasicGraphicsScene *GraphicsView::nodeScene()
 {
     return dynamic_cast<BasicGraphicsScene *>(scene());
 }
 
+void GraphicsView::updateLevelOfDetail()
+{
+    auto scene = nodeScene();
+
+    if (!scene)
+        return;
+
+    auto const &flowViewStyle = StyleCollection::flowViewStyle();
+
+    // Items pick their painting tier from each view's transform. The scene's
+    // tier only decides whether widgets are live, so it follows the most
+    // detailed view rather than the one zoomed last.
+    LevelOfDetail lod = LevelOfDetail::Minimal;
+
+    for (QGraphicsView *view : scene->views())
+        lod = std::min(lod, flowViewStyle.levelOfDetail(view->transform().m11()));
+
+    scene->setLevelOfDetail(lod);
+}
+
+void GraphicsView::updateVisibleSceneRect()
+{
+    if (auto scene = nodeScene())
+        scene->setVisibleSceneRect(mapToScene(viewport()->rect()).boundingRect());
+}
+
 QPointF GraphicsView::scenePastePosition()
 {
     QPoint origin = mapFromGlobal(QCursor::pos());
@@ -15,6 +15,8 @@ inline void initResources()
 }
 
 GraphicsViewStyle::GraphicsViewStyle()
+    : SimplifiedDetailScale(0.4f)
+    , MinimalDetailScale(0.2f)
 {
     // Explicit resources inialization for preventing the static initialization
     // order fiasco: https://isocpp.org/wiki/faq/ctors#static-init-order
@@ -25,6 +27,8 @@ GraphicsViewStyle::GraphicsViewStyle()
 }
 
 GraphicsViewStyle::GraphicsViewStyle(QString jsonText)
+    : SimplifiedDetailScale(0.4f)
+    , MinimalDetailScale(0.2f)
 {
     loadJsonText(jsonText);
 }
@@ -36,6 +40,17 @@ void GraphicsViewStyle::setStyle(QString jsonText)
     StyleCollection::setGraphicsViewStyle(style);
 }
 
+QtNodes::LevelOfDetail GraphicsViewStyle::levelOfDetail(double scale) const
+{
+    if (scale < MinimalDetailScale)
+        return LevelOfDetail::Minimal;
+
+    if (scale < SimplifiedDetailScale)
+        return LevelOfDetail::Simplified;
+
+    return LevelOfDetail::Full;
+}
+
 #ifdef STYLE_DEBUG
 #define FLOW_VIEW_STYLE_CHECK_UNDEFINED_VALUE(v, variable) \
     { \
@@ -68,6 +83,19 @@ void GraphicsViewStyle::setStyle(QString jsonText)
         values[#variable] = variable.name(); \
     }
 
+// Optional values: user styles written before the value existed keep the default.
+#define FLOW_VIEW_STYLE_READ_FLOAT(values, variable) \
+    { \
+        auto valueRef = values[#variable]; \
+        if (valueRef.isDouble()) \
+            variable = valueRef.toDouble(); \
+    }
+
+#define FLOW_VIEW_STYLE_WRITE_FLOAT(values, variable) \
+    { \
+        values[#variable] = variable; \
+    }
+
 void GraphicsViewStyle::loadJson(QJsonObject const &json)
 {
     QJsonValue nodeStyleValues = json["GraphicsViewStyle"];
@@ -77,6 +105,9 @@ void GraphicsViewStyle::loadJson(QJsonObject const &json)
     FLOW_VIEW_STYLE_READ_COLOR(obj, BackgroundColor);
     FLOW_VIEW_STYLE_READ_COLOR(obj, FineGridColor);
     FLOW_VIEW_STYLE_READ_COLOR(obj, CoarseGridColor);
+
+    FLOW_VIEW_STYLE_READ_FLOAT(obj, SimplifiedDetailScale);
+    FLOW_VIEW_STYLE_READ_FLOAT(obj, MinimalDetailScale);
 }
 
 QJsonObject GraphicsViewStyle::toJson() const
@@ -87,6 +118,9 @@ QJsonObject GraphicsViewStyle::toJson() const
     FLOW_VIEW_STYLE_WRITE_COLOR(obj, FineGridColor);
     FLOW_VIEW_STYLE_WRITE_COLOR(obj, CoarseGridColor);
 
+    FLOW_VIEW_STYLE_WRITE_FLOAT(obj, SimplifiedDetailScale);
+    FLOW_VIEW_STYLE_WRITE_FLOAT(obj, MinimalDetailScale);
+
     QJsonObject root;
     root["GraphicsViewStyle"] = obj;
 
@@ -0,0 +1,754 @@
+#include "LayeredLayout.hpp"
+
+#include "AbstractGraphModel.hpp"
+#include "AbstractNodeGeometry.hpp"
+#include "BasicGraphicsScene.hpp"
+#include "UndoCommands.hpp"
+
+#include <QtCore/QRunnable>
+#include <QUndoStack>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace QtNodes {
+
+namespace {
+
+// Upper bound of barycenter sweeps (one down and one up pass each).
+int const MaxOrderingSweeps = 24;
+
+// Sweeps without fewer crossings before the ordering stops early.
+int const MaxSweepsWithoutImprovement = 4;
+
+// Rounds of the alignment of connected nodes across layers.
+int const AlignmentRounds = 8;
+
+class FunctionTask : public QRunnable
+{
+public:
+    explicit FunctionTask(std::function<void()> function)
+        : _function(std::move(function))
+    {}
+
+    void run() override { _function(); }
+
+private:
+    std::function<void()> _function;
+};
+
+/**
+ * Graph in which every edge connects two consecutive layers. Vertices
+ * [0, realCount) are the nodes; the others are dummies splitting longer edges.
+ */
+struct LayeredGraph
+{
+    int realCount = 0;
+
+    std::vector<int> layer;
+
+    /// Neighbours in the previous and in the next layer.
+    std::vector<std::vector<int>> up;
+    std::vector<std::vector<int>> down;
+
+    /// Vertices of each layer in their current order.
+    std::vector<std::vector<int>> layers;
+
+    /// Index of each vertex within its layer.
+    std::vector<int> position;
+
+    int vertexCount() const { return static_cast<int>(layer.size()); }
+
+    bool isDummy(int v) const { return v >= realCount; }
+};
+
+/// Deduplicated adjacency without self-loops.
+std::vector<std::vector<int>> successors(int nodeCount, std::vector<std::pair<int, int>> edges)
+{
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<std::vector<int>> result(nodeCount);
+
+    for (auto const &e : edges) {
+        if (e.first != e.second)
+            result[e.first].push_back(e.second);
+    }
+
+    return result;
+}
+
+/// Reverses the back edges found by a depth-first search.
+std::vector<std::vector<int>> breakCycles(std::vector<std::vector<int>> const &out)
+{
+    int const n = static_cast<int>(out.size());
+
+    enum State : char { Unvisited, OnStack, Done };
+
+    std::vector<char> state(n, Unvisited);
+
+    std::vector<std::pair<int, int>> edges;
+
+    // Iterative, the graphs may be deep enough to overflow the call stack.
+    std::vector<std::pair<int, std::size_t>> stack;
+
+    for (int root = 0; root < n; ++root) {
+        if (state[root] != Unvisited)
+            continue;
+
+        state[root] = OnStack;
+        stack.emplace_back(root, 0);
+
+        while (!stack.empty()) {
+            int const v = stack.back().first;
+            std::size_t &next = stack.back().second;
+
+            if (next == out[v].size()) {
+                state[v] = Done;
+                stack.pop_back();
+                continue;
+            }
+
+            int const w = out[v][next++];
+
+            if (state[w] == OnStack) {
+                edges.emplace_back(w, v);
+            } else {
+                edges.emplace_back(v, w);
+
+                if (state[w] == Unvisited) {
+                    state[w] = OnStack;
+                    stack.emplace_back(w, 0);
+                }
+            }
+        }
+    }
+
+    return successors(n, std::move(edges));
+}
+
+/// Longest-path layering; sources are then moved next to their successors.
+std::vector<int> assignLayers(std::vector<std::vector<int>> const &out)
+{
+    int const n = static_cast<int>(out.size());
+
+    std::vector<int> inDegree(n, 0);
+
+    for (auto const &targets : out) {
+        for (int w : targets)
+            ++inDegree[w];
+    }
+
+    std::vector<int> order;
+    order.reserve(n);
+
+    for (int v = 0; v < n; ++v) {
+        if (inDegree[v] == 0)
+            order.push_back(v);
+    }
+
+    std::vector<int> layer(n, 0);
+
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        int const v = order[i];
+
+        for (int w : out[v]) {
+            layer[w] = std::max(layer[w], layer[v] + 1);
+
+            if (--inDegree[w] == 0)
+                order.push_back(w);
+        }
+    }
+
+    // Sources all start in the first layer, which stretches their edges.
+    std::vector<bool> hasPredecessor(n, false);
+
+    for (auto const &targets : out) {
+        for (int w : targets)
+            hasPredecessor[w] = true;
+    }
+
+    for (int v = 0; v < n; ++v) {
+        if (hasPredecessor[v] || out[v].empty())
+            continue;
+
+        int minLayer = std::numeric_limits<int>::max();
+
+        for (int w : out[v])
+            minLayer = std::min(minLayer, layer[w]);
+
+        layer[v] = minLayer - 1;
+    }
+
+    return layer;
+}
+
+LayeredGraph buildLayeredGraph(std::vector<std::vector<int>> const &out,
+                               std::vector<int> const &layer)
+{
+    LayeredGraph g;
+
+    g.realCount = static_cast<int>(out.size());
+    g.layer = layer;
+    g.up.resize(g.realCount);
+    g.down.resize(g.realCount);
+
+    auto link = [&g](int from, int to) {
+        g.down[from].push_back(to);
+        g.up[to].push_back(from);
+    };
+
+    for (int v = 0; v < g.realCount; ++v) {
+        for (int w : out[v]) {
+            int previous = v;
+
+            for (int l = layer[v] + 1; l < layer[w]; ++l) {
+                int const dummy = g.vertexCount();
+
+                g.layer.push_back(l);
+                g.up.emplace_back();
+                g.down.emplace_back();
+
+                link(previous, dummy);
+                previous = dummy;
+            }
+
+            link(previous, w);
+        }
+    }
+
+    int layerCount = 0;
+
+    for (int l : g.layer)
+        layerCount = std::max(layerCount, l + 1);
+
+    g.layers.resize(layerCount);
+    g.position.assign(g.vertexCount(), -1);
+
+    // Depth-first discovery order keeps connected vertices together.
+    std::vector<int> stack;
+
+    auto place = [&g](int v) {
+        std::vector<int> &vertices = g.layers[g.layer[v]];
+        g.position[v] = static_cast<int>(vertices.size());
+        vertices.push_back(v);
+    };
+
+    for (int root = 0; root < g.realCount; ++root) {
+        if (g.position[root] >= 0 || !g.up[root].empty())
+            continue;
+
+        place(root);
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            int const v = stack.back();
+            stack.pop_back();
+
+            for (auto it = g.down[v].rbegin(); it != g.down[v].rend(); ++it) {
+                if (g.position[*it] < 0) {
+                    place(*it);
+                    stack.push_back(*it);
+                }
+            }
+        }
+    }
+
+    return g;
+}
+
+/// Crossings between layer `l` and the next one, counted as inversions.
+long long countCrossings(LayeredGraph const &g, int l)
+{
+    std::vector<std::pair<int, int>> edges;
+
+    for (int v : g.layers[l]) {
+        for (int w : g.down[v])
+            edges.emplace_back(g.position[v], g.position[w]);
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    // Fenwick tree over the positions in the next layer.
+    int const size = static_cast<int>(g.layers[l + 1].size());
+
+    std::vector<int> tree(size + 1, 0);
+
+    long long crossings = 0;
+    int inserted = 0;
+
+    for (auto const &e : edges) {
+        int greater = inserted;
+
+        for (int i = e.second + 1; i > 0; i -= i & -i)
+            greater -= tree[i];
+
+        crossings += greater;
+
+        for (int i = e.second + 1; i <= size; i += i & -i)
+            ++tree[i];
+
+        ++inserted;
+    }
+
+    return crossings;
+}
+
+long long countCrossings(LayeredGraph const &g)
+{
+    long long crossings = 0;
+
+    for (int l = 0; l + 1 < static_cast<int>(g.layers.size()); ++l)
+        crossings += countCrossings(g, l);
+
+    return crossings;
+}
+
+/// Orders layer `l` by the mean position of the neighbours in `neighbours`.
+void sortByBarycenter(LayeredGraph &g, int l, std::vector<std::vector<int>> const &neighbours)
+{
+    std::vector<int> &vertices = g.layers[l];
+
+    std::vector<double> key(vertices.size());
+
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        std::vector<int> const &adjacent = neighbours[vertices[i]];
+
+        // Unconnected vertices keep their place.
+        if (adjacent.empty()) {
+            key[i] = static_cast<double>(i);
+            continue;
+        }
+
+        double sum = 0.0;
+
+        for (int w : adjacent)
+            sum += g.position[w];
+
+        key[i] = sum / adjacent.size();
+    }
+
+    std::vector<int> order(vertices.size());
+
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = static_cast<int>(i);
+
+    std::stable_sort(order.begin(), order.end(), [&key](int a, int b) { return key[a] < key[b]; });
+
+    std::vector<int> sorted(vertices.size());
+
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        sorted[i] = vertices[order[i]];
+        g.position[sorted[i]] = static_cast<int>(i);
+    }
+
+    vertices.swap(sorted);
+}
+
+void minimizeCrossings(LayeredGraph &g, std::atomic<bool> const &canceled)
+{
+    int const layerCount = static_cast<int>(g.layers.size());
+
+    long long bestCrossings = countCrossings(g);
+
+    std::vector<std::vector<int>> bestLayers = g.layers;
+
+    int sweepsWithoutImprovement = 0;
+
+    for (int sweep = 0; sweep < MaxOrderingSweeps && bestCrossings > 0; ++sweep) {
+        if (canceled)
+            return;
+
+        for (int l = 1; l < layerCount; ++l)
+            sortByBarycenter(g, l, g.up);
+
+        for (int l = layerCount - 2; l >= 0; --l)
+            sortByBarycenter(g, l, g.down);
+
+        long long const crossings = countCrossings(g);
+
+        if (crossings < bestCrossings) {
+            bestCrossings = crossings;
+            bestLayers = g.layers;
+            sweepsWithoutImprovement = 0;
+        } else if (++sweepsWithoutImprovement == MaxSweepsWithoutImprovement) {
+            break;
+        }
+    }
+
+    g.layers.swap(bestLayers);
+
+    for (auto const &vertices : g.layers) {
+        for (std::size_t i = 0; i < vertices.size(); ++i)
+            g.position[vertices[i]] = static_cast<int>(i);
+    }
+}
+
+/**
+ * Moves the centers of `vertices` as close as possible to `targets` (least
+ * squares) while keeping their order and the minimum distances `gaps` between
+ * neighbours. Shifting out the gaps turns this into an isotonic regression,
+ * solved by pooling adjacent violators.
+ */
+void placeLayer(std::vector<int> const &vertices,
+                std::vector<double> const &targets,
+                std::vector<double> const &gaps,
+                std::vector<double> &center)
+{
+    std::size_t const n = vertices.size();
+
+    std::vector<double> offset(n, 0.0);
+
+    for (std::size_t i = 1; i < n; ++i)
+        offset[i] = offset[i - 1] + gaps[i - 1];
+
+    struct Block
+    {
+        double sum;
+        int count;
+        double mean() const { return sum / count; }
+    };
+
+    std::vector<Block> blocks;
+    blocks.reserve(n);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        blocks.push_back(Block{targets[i] - offset[i], 1});
+
+        while (blocks.size() > 1 && blocks[blocks.size() - 2].mean() > blocks.back().mean()) {
+            Block const last = blocks.back();
+            blocks.pop_back();
+            blocks.back().sum += last.sum;
+            blocks.back().count += last.count;
+        }
+    }
+
+    std::size_t i = 0;
+
+    for (Block const &block : blocks) {
+        for (int k = 0; k < block.count; ++k, ++i)
+            center[vertices[i]] = block.mean() + offset[i];
+    }
+}
+
+} // namespace
+
+struct LayeredLayout::Job
+{
+    std::vector<NodeId> nodeIds;
+
+    Graph graph;
+
+    Qt::Orientation orientation;
+
+    double layerSpacing;
+
+    double nodeSpacing;
+
+    /// Top-left corner of the nodes before the layout.
+    QPointF origin;
+
+    std::atomic<bool> canceled;
+
+    std::vector<QPointF> positions;
+};
+
+LayeredLayout::LayeredLayout(BasicGraphicsScene &scene, QObject *parent)
+    : QObject(parent)
+    , _scene(scene)
+    , _layerSpacing(80.0)
+    , _nodeSpacing(30.0)
+    , _threadThreshold(1000)
+{
+    _pool.setMaxThreadCount(1);
+}
+
+LayeredLayout::~LayeredLayout()
+{
+    cancel();
+
+    _pool.waitForDone();
+}
+
+void LayeredLayout::setLayerSpacing(double spacing)
+{
+    _layerSpacing = qMax(spacing, 0.0);
+}
+
+void LayeredLayout::setNodeSpacing(double spacing)
+{
+    _nodeSpacing = qMax(spacing, 0.0);
+}
+
+void LayeredLayout::setThreadThreshold(int nodeCount)
+{
+    _threadThreshold = qMax(nodeCount, 0);
+}
+
+void LayeredLayout::start()
+{
+    cancel();
+
+    AbstractGraphModel &model = _scene.graphModel();
+    AbstractNodeGeometry &geometry = _scene.nodeGeometry();
+
+    auto job = std::make_shared<Job>();
+
+    job->orientation = _scene.orientation();
+    job->layerSpacing = _layerSpacing;
+    job->nodeSpacing = _nodeSpacing;
+    job->canceled = false;
+
+    std::unordered_set<NodeId> const nodeIds = model.allNodeIds();
+
+    // Sorted, so that the same graph always gets the same layout.
+    job->nodeIds.assign(nodeIds.begin(), nodeIds.end());
+    std::sort(job->nodeIds.begin(), job->nodeIds.end());
+
+    std::unordered_map<NodeId, int> index;
+    index.reserve(job->nodeIds.size());
+
+    job->graph.sizes.reserve(job->nodeIds.size());
+
+    qreal left = std::numeric_limits<qreal>::max();
+    qreal top = std::numeric_limits<qreal>::max();
+
+    for (std::size_t i = 0; i < job->nodeIds.size(); ++i) {
+        NodeId const nodeId = job->nodeIds[i];
+
+        index[nodeId] = static_cast<int>(i);
+
+        job->graph.sizes.push_back(QSizeF(geometry.size(nodeId)));
+
+        QPointF const pos = model.nodeData<QPointF>(nodeId, NodeRole::Position);
+
+        left = qMin(left, pos.x());
+        top = qMin(top, pos.y());
+    }
+
+    job->origin = job->nodeIds.empty() ? QPointF() : QPointF(left, top);
+
+    std::unordered_set<ConnectionId> const connections = model.allConnections();
+
+    job->graph.edges.reserve(connections.size());
+
+    for (ConnectionId const &connectionId : connections) {
+        auto const out = index.find(connectionId.outNodeId);
+        auto const in = index.find(connectionId.inNodeId);
+
+        if (out != index.end() && in != index.end())
+            job->graph.edges.emplace_back(out->second, in->second);
+    }
+
+    _job = job;
+
+    if (static_cast<int>(job->nodeIds.size()) < _threadThreshold) {
+        job->positions = computePositions(job->graph,
+                                          job->orientation,
+                                          job->layerSpacing,
+                                          job->nodeSpacing,
+                                          job->canceled);
+        apply(job);
+        return;
+    }
+
+    // The object outlives the task: the destructor waits for the pool.
+    _pool.start(new FunctionTask([this, job]() {
+        job->positions = computePositions(job->graph,
+                                          job->orientation,
+                                          job->layerSpacing,
+                                          job->nodeSpacing,
+                                          job->canceled);
+
+        QMetaObject::invokeMethod(
+            this, [this, job]() { apply(job); }, Qt::QueuedConnection);
+    }));
+}
+
+void LayeredLayout::cancel()
+{
+    if (!_job)
+        return;
+
+    _job->canceled = true;
+    _job.reset();
+}
+
+void LayeredLayout::apply(std::shared_ptr<Job> const &job)
+{
+    // Canceled, or superseded by a later start().
+    if (job != _job || job->canceled)
+        return;
+
+    _job.reset();
+
+    AbstractGraphModel &model = _scene.graphModel();
+
+    std::unordered_map<NodeId, QPointF> newPositions;
+    newPositions.reserve(job->positions.size());
+
+    for (std::size_t i = 0; i < job->positions.size(); ++i) {
+        NodeId const nodeId = job->nodeIds[i];
+
+        // The scene stayed interactive while the layout was computed.
+        if (model.nodeExists(nodeId))
+            newPositions[nodeId] = job->origin + job->positions[i];
+    }
+
+    if (!newPositions.empty())
+        _scene.undoStack().push(new LayoutCommand(&_scene, std::move(newPositions)));
+
+    Q_EMIT finished();
+}
+
+std::vector<QPointF> LayeredLayout::computePositions(Graph const &graph,
+                                                     Qt::Orientation const orientation,
+                                                     double const layerSpacing,
+                                                     double const nodeSpacing,
+                                                     std::atomic<bool> const &canceled)
+{
+    int const nodeCount = static_cast<int>(graph.sizes.size());
+
+    if (nodeCount == 0)
+        return {};
+
+    std::vector<std::vector<int>> const out = breakCycles(successors(nodeCount, graph.edges));
+
+    LayeredGraph g = buildLayeredGraph(out, assignLayers(out));
+
+    if (canceled)
+        return {};
+
+    minimizeCrossings(g, canceled);
+
+    if (canceled)
+        return {};
+
+    bool const horizontal = (orientation == Qt::Horizontal);
+
+    int const vertexCount = g.vertexCount();
+    int const layerCount = static_cast<int>(g.layers.size());
+
+    // Extent of a vertex along its layer and across it; dummies take no space.
+    std::vector<double> extent(vertexCount, 0.0);
+    std::vector<double> thickness(vertexCount, 0.0);
+
+    for (int v = 0; v < nodeCount; ++v) {
+        QSizeF const &size = graph.sizes[v];
+
+        extent[v] = horizontal ? size.height() : size.width();
+        thickness[v] = horizontal ? size.width() : size.height();
+    }
+
+    std::vector<std::vector<double>> gaps(layerCount);
+
+    std::vector<double> center(vertexCount, 0.0);
+
+    for (int l = 0; l < layerCount; ++l) {
+        std::vector<int> const &vertices = g.layers[l];
+
+        for (std::size_t i = 1; i < vertices.size(); ++i) {
+            int const a = vertices[i - 1];
+            int const b = vertices[i];
+
+            // Edges passing through a layer may run closer than nodes.
+            double const spacing = (g.isDummy(a) || g.isDummy(b)) ? nodeSpacing / 2.0
+                                                                  : nodeSpacing;
+
+            gaps[l].push_back((extent[a] + extent[b]) / 2.0 + spacing);
+        }
+
+        // Packed and centered on the layer axis.
+        double length = 0.0;
+
+        for (double gap : gaps[l])
+            length += gap;
+
+        double c = -length / 2.0;
+
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            center[vertices[i]] = c;
+
+            if (i < gaps[l].size())
+                c += gaps[l][i];
+        }
+    }
+
+    auto align = [&](int l, bool useUp, bool useDown) {
+        std::vector<int> const &vertices = g.layers[l];
+
+        std::vector<double> targets(vertices.size());
+
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            int const v = vertices[i];
+
+            double sum = 0.0;
+            int count = 0;
+
+            if (useUp) {
+                for (int w : g.up[v])
+                    sum += center[w];
+                count += static_cast<int>(g.up[v].size());
+            }
+
+            if (useDown) {
+                for (int w : g.down[v])
+                    sum += center[w];
+                count += static_cast<int>(g.down[v].size());
+            }
+
+            targets[i] = count > 0 ? sum / count : center[v];
+        }
+
+        placeLayer(vertices, targets, gaps[l], center);
+    };
+
+    for (int round = 0; round < AlignmentRounds; ++round) {
+        if (canceled)
+            return {};
+
+        for (int l = 1; l < layerCount; ++l)
+            align(l, true, false);
+
+        for (int l = layerCount - 2; l >= 0; --l)
+            align(l, false, true);
+    }
+
+    for (int l = 0; l < layerCount; ++l)
+        align(l, true, true);
+
+    std::vector<double> layerThickness(layerCount, 0.0);
+
+    for (int v = 0; v < nodeCount; ++v)
+        layerThickness[g.layer[v]] = std::max(layerThickness[g.layer[v]], thickness[v]);
+
+    std::vector<double> layerStart(layerCount, 0.0);
+
+    for (int l = 1; l < layerCount; ++l)
+        layerStart[l] = layerStart[l - 1] + layerThickness[l - 1] + layerSpacing;
+
+    std::vector<QPointF> positions(nodeCount);
+
+    double minAlong = std::numeric_limits<double>::max();
+
+    for (int v = 0; v < nodeCount; ++v) {
+        int const l = g.layer[v];
+
+        double const along = center[v] - extent[v] / 2.0;
+        double const across = layerStart[l] + (layerThickness[l] - thickness[v]) / 2.0;
+
+        minAlong = std::min(minAlong, along);
+
+        positions[v] = horizontal ? QPointF(across, along) : QPointF(along, across);
+    }
+
+    QPointF const shift = horizontal ? QPointF(0.0, -minAlong) : QPointF(-minAlong, 0.0);
+
+    for (QPointF &p : positions)
+        p += shift;
+
+    return positions;
+}
+
+} // namespace QtNodes
@@ -0,0 +1,317 @@
+#include "MiniMap.hpp"
+
+#include "AbstractGraphModel.hpp"
+#include "AbstractNodeGeometry.hpp"
+#include "BasicGraphicsScene.hpp"
+#include "GraphicsView.hpp"
+#include "StyleCollection.hpp"
+
+#include <QtCore/QTimer>
+#include <QtGui/QMouseEvent>
+#include <QtGui/QPainter>
+
+namespace QtNodes {
+
+namespace {
+
+// Empty space kept around the nodes, relative to their extent.
+double const SceneMarginRatio = 0.1;
+
+// Nodes are never drawn smaller than this many pixels.
+double const MinNodeExtent = 2.0;
+
+// Extra space added on each side, relative to the new extent, when a node
+// leaves the covered range. Dragging a node outward then remaps the image
+// only every so often instead of on every move.
+double const GrowthRatio = 0.5;
+
+} // namespace
+
+MiniMap::MiniMap(QWidget *parent)
+    : QWidget(parent)
+    , _growPending(false)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setCursor(Qt::PointingHandCursor);
+}
+
+MiniMap::MiniMap(BasicGraphicsScene *scene, GraphicsView *view, QWidget *parent)
+    : MiniMap(parent)
+{
+    setScene(scene);
+    setView(view);
+}
+
+void MiniMap::setScene(BasicGraphicsScene *scene)
+{
+    if (_scene) {
+        disconnect(&_scene->graphModel(), nullptr, this, nullptr);
+    }
+
+    _scene = scene;
+
+    if (_scene) {
+        AbstractGraphModel *model = &_scene->graphModel();
+
+        connect(model, &AbstractGraphModel::nodeCreated, this, &MiniMap::updateNode);
+        connect(model, &AbstractGraphModel::nodePositionUpdated, this, &MiniMap::updateNode);
+        connect(model, &AbstractGraphModel::nodeUpdated, this, &MiniMap::updateNode);
+        connect(model, &AbstractGraphModel::nodeDeleted, this, &MiniMap::removeNode);
+        connect(model, &AbstractGraphModel::modelReset, this, &MiniMap::rebuild);
+    }
+
+    rebuild();
+}
+
+void MiniMap::setView(GraphicsView *view)
+{
+    if (_view)
+        _view->viewport()->removeEventFilter(this);
+
+    _view = view;
+
+    // Every scroll or zoom repaints the viewport.
+    if (_view)
+        _view->viewport()->installEventFilter(this);
+
+    update();
+}
+
+QSize MiniMap::sizeHint() const
+{
+    return QSize(200, 150);
+}
+
+void MiniMap::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+
+    if (_image.isNull())
+        painter.fillRect(rect(), StyleCollection::flowViewStyle().BackgroundColor);
+    else
+        painter.drawImage(0, 0, _image);
+
+    if (!_view)
+        return;
+
+    QRectF const visible = _view->mapToScene(_view->viewport()->rect()).boundingRect();
+
+    QRectF const frame = _sceneToImage.mapRect(visible).intersected(QRectF(rect()));
+
+    if (frame.isEmpty())
+        return;
+
+    auto const &flowViewStyle = StyleCollection::flowViewStyle();
+
+    painter.setPen(QPen(flowViewStyle.CoarseGridColor.lighter(200), 1.0));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(frame.adjusted(0.5, 0.5, -0.5, -0.5));
+}
+
+void MiniMap::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+
+    rebuild();
+}
+
+void MiniMap::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+        centerViewOn(event->pos());
+}
+
+void MiniMap::mouseMoveEvent(QMouseEvent *event)
+{
+    if (event->buttons() & Qt::LeftButton)
+        centerViewOn(event->pos());
+}
+
+bool MiniMap::eventFilter(QObject *watched, QEvent *event)
+{
+    if (_view && watched == _view->viewport()
+        && (event->type() == QEvent::Paint || event->type() == QEvent::Resize)) {
+        update();
+    }
+
+    return QWidget::eventFilter(watched, event);
+}
+
+QRectF MiniMap::nodeRect(NodeId const nodeId) const
+{
+    QPointF const pos = _scene->graphModel().nodeData<QPointF>(nodeId, NodeRole::Position);
+
+    return QRectF(pos, _scene->nodeGeometry().size(nodeId));
+}
+
+void MiniMap::rebuild()
+{
+    _nodes.clear();
+
+    if (_scene) {
+        for (NodeId const nodeId : _scene->graphModel().allNodeIds())
+            _nodes.insert(nodeId, nodeRect(nodeId));
+    }
+
+    QRectF const bounds = _nodes.boundingRect();
+
+    remap(bounds.adjusted(-SceneMarginRatio * bounds.width(),
+                          -SceneMarginRatio * bounds.height(),
+                          SceneMarginRatio * bounds.width(),
+                          SceneMarginRatio * bounds.height()));
+}
+
+void MiniMap::remap(QRectF const &sceneRect)
+{
+    // Supersedes a pending growth.
+    _growPending = false;
+
+    _sceneRect = sceneRect;
+
+    if (_image.size() != size())
+        _image = QImage(size(), QImage::Format_RGB32);
+
+    _sceneToImage.reset();
+
+    if (!_sceneRect.isEmpty() && !_image.isNull()) {
+        // Fits the scene range into the widget, keeping the aspect ratio.
+        double const scale = qMin(_image.width() / _sceneRect.width(),
+                                  _image.height() / _sceneRect.height());
+
+        QPointF const offset((_image.width() - scale * _sceneRect.width()) / 2.0,
+                             (_image.height() - scale * _sceneRect.height()) / 2.0);
+
+        _sceneToImage.translate(offset.x(), offset.y());
+        _sceneToImage.scale(scale, scale);
+        _sceneToImage.translate(-_sceneRect.left(), -_sceneRect.top());
+
+        // The whole widget area, which may extend beyond the nodes' range.
+        _sceneRect = _sceneToImage.inverted().mapRect(QRectF(_image.rect()));
+    }
+
+    if (!_image.isNull()) {
+        _image.fill(StyleCollection::flowViewStyle().BackgroundColor);
+        redraw(_sceneRect);
+    }
+
+    update();
+}
+
+void MiniMap::redraw(QRectF const &sceneRect)
+{
+    if (_image.isNull() || _sceneRect.isEmpty())
+        return;
+
+    // Nodes grow right and down to the minimum extent.
+    QRect const dirty = _sceneToImage.mapRect(sceneRect)
+                            .adjusted(0, 0, MinNodeExtent, MinNodeExtent)
+                            .toAlignedRect()
+                            .intersected(_image.rect());
+
+    if (dirty.isEmpty())
+        return;
+
+    QPainter painter(&_image);
+    painter.setClipRect(dirty);
+
+    painter.fillRect(dirty, StyleCollection::flowViewStyle().BackgroundColor);
+
+    QColor const nodeColor = StyleCollection::nodeStyle().NormalBoundaryColor;
+
+    // Also catches small nodes whose enlarged pixels reach into the area.
+    double const slack = MinNodeExtent / _sceneToImage.m11();
+
+    QRectF const area = _sceneToImage.inverted().mapRect(QRectF(dirty)).adjusted(-slack,
+                                                                                 -slack,
+                                                                                 0,
+                                                                                 0);
+
+    _nodes.forEachIntersecting(area,
+                               [&](NodeId const &, QRectF const &r) {
+                                   QRectF mapped = _sceneToImage.mapRect(r);
+
+                                   mapped.setWidth(qMax(mapped.width(), MinNodeExtent));
+                                   mapped.setHeight(qMax(mapped.height(), MinNodeExtent));
+
+                                   painter.fillRect(mapped, nodeColor);
+                               });
+}
+
+void MiniMap::grow()
+{
+    QRectF const bounds = _sceneRect.united(_nodes.boundingRect());
+
+    remap(bounds.adjusted(-GrowthRatio * bounds.width(),
+                          -GrowthRatio * bounds.height(),
+                          GrowthRatio * bounds.width(),
+                          GrowthRatio * bounds.height()));
+}
+
+void MiniMap::scheduleGrow()
+{
+    if (_growPending)
+        return;
+
+    // Batched moves, such as an automatic layout, remap only once.
+    _growPending = true;
+
+    QTimer::singleShot(0, this, &MiniMap::grow);
+}
+
+void MiniMap::updateNode(NodeId const nodeId)
+{
+    if (!_scene || !_scene->graphModel().nodeExists(nodeId))
+        return;
+
+    QRectF const oldRect = _nodes.rect(nodeId);
+    QRectF const newRect = nodeRect(nodeId);
+
+    if (oldRect == newRect && _nodes.contains(nodeId))
+        return;
+
+    _nodes.insert(nodeId, newRect);
+
+    // The pending remap redraws everything.
+    if (_growPending)
+        return;
+
+    // Moving out of the covered range changes the mapping.
+    if (!_sceneRect.contains(newRect)) {
+        scheduleGrow();
+        return;
+    }
+
+    if (!oldRect.isNull())
+        redraw(oldRect);
+
+    redraw(newRect);
+
+    update();
+}
+
+void MiniMap::removeNode(NodeId const nodeId)
+{
+    if (!_nodes.contains(nodeId))
+        return;
+
+    QRectF const oldRect = _nodes.rect(nodeId);
+
+    _nodes.remove(nodeId);
+
+    if (_growPending)
+        return;
+
+    redraw(oldRect);
+
+    update();
+}
+
+void MiniMap::centerViewOn(QPoint const &pos)
+{
+    if (!_view || _sceneRect.isEmpty())
+        return;
+
+    _view->centerOn(_sceneToImage.inverted().map(QPointF(pos)));
+}
+
+} // namespace QtNodes
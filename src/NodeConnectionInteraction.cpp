@@ -107,10 +107,12 @@ bool NodeConnectionInteraction::disconnect(PortType portToDisconnect) const
 
     // Repaint connection points.
     NodeId connectedNodeId = getNodeId(oppositePort(portToDisconnect), connectionId);
-    _scene.nodeGraphicsObject(connectedNodeId)->update();
+    if (auto ngo = _scene.nodeGraphicsObject(connectedNodeId))
+        ngo->update();
 
     NodeId disconnectedNodeId = getNodeId(portToDisconnect, connectionId);
-    _scene.nodeGraphicsObject(disconnectedNodeId)->update();
+    if (auto ngo = _scene.nodeGraphicsObject(disconnectedNodeId))
+        ngo->update();
 
     return true;
 }
@@ -5,7 +5,6 @@
 namespace QtNodes {
 
 NodeDelegateModel::NodeDelegateModel()
-    : _nodeStyle(StyleCollection::nodeStyle())
 {
     // Derived classes can initialize specific style here
 }
@@ -42,12 +41,21 @@ ConnectionPolicy NodeDelegateModel::portConnectionPolicy(PortType portType, Port
 
 NodeStyle const &NodeDelegateModel::nodeStyle() const
 {
-    return _nodeStyle;
+    return _nodeStyle ? *_nodeStyle : StyleCollection::nodeStyle();
+}
+
+std::shared_ptr<NodeStyle const> NodeDelegateModel::sharedNodeStyle() const
+{
+    return _nodeStyle ? _nodeStyle : StyleCollection::sharedNodeStyle();
 }
 
 void NodeDelegateModel::setNodeStyle(NodeStyle const &style)
 {
-    _nodeStyle = style;
+    _nodeStyle = std::make_shared<NodeStyle const>(style);
+
+    // Only this node's cached style is outdated; the graph model turns this
+    // into nodeUpdated for the node.
+    Q_EMIT nodeStyleUpdated();
 }
 
 } // namespace QtNodes
@@ -34,3 +34,8 @@ NodeDelegateModelRegistry::CategoriesSet const &NodeDelegateModelRegistry::categ
 {
     return _categories;
 }
+
+std::size_t NodeDelegateModelRegistry::version() const
+{
+    return _version;
+}
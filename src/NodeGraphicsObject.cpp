@@ -13,6 +13,7 @@
 #include "ConnectionGraphicsObject.hpp"
 #include "ConnectionIdUtils.hpp"
 #include "NodeConnectionInteraction.hpp"
+#include "PaintCounters.hpp"
 #include "StyleCollection.hpp"
 #include "UndoCommands.hpp"
 
@@ -23,6 +24,8 @@ NodeGraphicsObject::NodeGraphicsObject(BasicGraphicsScene &scene, NodeId nodeId)
     , _graphModel(scene.graphModel())
     , _nodeState(*this)
     , _proxyWidget(nullptr)
+    , _embeddedWidgetPending(false)
+    , _nodeStyleVersion(0)
 {
     scene.addItem(this);
 
@@ -33,20 +36,7 @@ NodeGraphicsObject::NodeGraphicsObject(BasicGraphicsScene &scene, NodeId nodeId)
 
     setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 
-    QJsonObject nodeStyleJson = _graphModel.nodeData(_nodeId, NodeRole::Style).toJsonObject();
-
-    NodeStyle nodeStyle(nodeStyleJson);
-
-    {
-        auto effect = new QGraphicsDropShadowEffect;
-        effect->setOffset(4, 4);
-        effect->setBlurRadius(20);
-        effect->setColor(nodeStyle.ShadowColor);
-
-        setGraphicsEffect(effect);
-    }
-
-    setOpacity(nodeStyle.Opacity);
+    applyNodeStyle();
 
     setAcceptHoverEvents(true);
 
@@ -54,6 +44,8 @@ NodeGraphicsObject::NodeGraphicsObject(BasicGraphicsScene &scene, NodeId nodeId)
 
     embedQWidget();
 
+    applyLevelOfDetail(scene.levelOfDetail());
+
     nodeScene()->nodeGeometry().recomputeSize(_nodeId);
 
     QPointF const pos = _graphModel.nodeData<QPointF>(_nodeId, NodeRole::Position);
@@ -76,38 +68,179 @@ BasicGraphicsScene *NodeGraphicsObject::nodeScene() const
     return dynamic_cast<BasicGraphicsScene *>(scene());
 }
 
+void NodeGraphicsObject::setNodeId(NodeId const nodeId)
+{
+    releaseEmbeddedWidget();
+
+    prepareGeometryChange();
+
+    _nodeId = nodeId;
+
+    _nodeState.setHovered(false);
+    _nodeState.setResizing(false);
+    _nodeState.resetConnectionForReaction();
+
+    invalidateNodeStyle();
+
+    setSelected(false);
+
+    setZValue(0);
+
+    // Pooled objects are parked with an invalid id until reused.
+    if (_nodeId == InvalidNodeId)
+        return;
+
+    setLockedState();
+
+    applyNodeStyle();
+
+    embedQWidget();
+
+    applyLevelOfDetail(nodeScene()->levelOfDetail());
+
+    nodeScene()->nodeGeometry().recomputeSize(_nodeId);
+
+    setPos(_graphModel.nodeData<QPointF>(_nodeId, NodeRole::Position));
+
+    update();
+}
+
+QWidget *NodeGraphicsObject::releaseEmbeddedWidget()
+{
+    if (!_proxyWidget)
+        return nullptr;
+
+    QWidget *w = _proxyWidget->widget();
+
+    if (w) {
+        _proxyWidget->setWidget(nullptr);
+        w->hide();
+    }
+
+    delete _proxyWidget;
+    _proxyWidget = nullptr;
+
+    _embeddedWidgetPending = false;
+
+    invalidateWidgetSnapshot();
+
+    return w;
+}
+
+void NodeGraphicsObject::applyNodeStyle()
+{
+    NodeStyle const &nodeStyle = this->nodeStyle();
+
+    auto effect = qobject_cast<QGraphicsDropShadowEffect *>(graphicsEffect());
+
+    // The painter's shadow margins depend on the mode.
+    prepareGeometryChange();
+
+    if (nodeScene()->nodeShadowEffectEnabled()) {
+        if (!effect) {
+            effect = new QGraphicsDropShadowEffect;
+            effect->setOffset(4, 4);
+            effect->setBlurRadius(20);
+
+            setGraphicsEffect(effect);
+        }
+
+        effect->setColor(nodeStyle.ShadowColor);
+        effect->setEnabled(nodeScene()->levelOfDetail() == LevelOfDetail::Full);
+    } else if (effect) {
+        // Deletes the effect.
+        setGraphicsEffect(nullptr);
+    }
+
+    setOpacity(nodeStyle.Opacity);
+}
+
 void NodeGraphicsObject::embedQWidget()
 {
     AbstractNodeGeometry &geometry = nodeScene()->nodeGeometry();
     geometry.recomputeSize(_nodeId);
 
+    // Laid out with the model's size hint until the widget is needed.
+    _embeddedWidgetPending = embeddedWidgetDeferred();
+
+    if (_embeddedWidgetPending)
+        return;
+
     if (auto w = _graphModel.nodeData(_nodeId, NodeRole::Widget).value<QWidget *>()) {
         _proxyWidget = new QGraphicsProxyWidget(this);
 
         _proxyWidget->setWidget(w);
 
+        // A widget released by a recycled node object was hidden on release.
+        _proxyWidget->show();
+
         _proxyWidget->setPreferredWidth(5);
 
         geometry.recomputeSize(_nodeId);
 
-        if (w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag) {
-            unsigned int widgetHeight = geometry.size(_nodeId).height()
-                                        - geometry.captionRect(_nodeId).height();
-
-            // If the widget wants to use as much vertical space as possible, set
-            // it to have the geom's equivalentWidgetHeight.
-            _proxyWidget->setMinimumHeight(widgetHeight);
-        }
-
-        _proxyWidget->setPos(geometry.widgetPosition(_nodeId));
+        updateEmbeddedWidgetGeometry();
 
         //update();
 
         _proxyWidget->setOpacity(1.0);
         _proxyWidget->setFlag(QGraphicsItem::ItemIgnoresParentOpacity);
+
+        _embeddedWidgetSize = w->size();
     }
 }
 
+void NodeGraphicsObject::updateEmbeddedWidgetGeometry()
+{
+    if (!_proxyWidget || !_proxyWidget->widget())
+        return;
+
+    AbstractNodeGeometry &geometry = nodeScene()->nodeGeometry();
+
+    if (_proxyWidget->widget()->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag) {
+        unsigned int widgetHeight = geometry.size(_nodeId).height()
+                                    - geometry.captionRect(_nodeId).height();
+
+        // If the widget wants to use as much vertical space as possible, set
+        // it to have the geom's equivalentWidgetHeight.
+        _proxyWidget->setMinimumHeight(widgetHeight);
+    }
+
+    _proxyWidget->setPos(geometry.widgetPosition(_nodeId));
+}
+
+bool NodeGraphicsObject::embeddedWidgetDeferred() const
+{
+    // No hint, or the widget exists already.
+    if (!_graphModel.nodeData<QSize>(_nodeId, NodeRole::WidgetSizeHint).isValid())
+        return false;
+
+    BasicGraphicsScene *scene = nodeScene();
+
+    if (scene->levelOfDetail() != LevelOfDetail::Full)
+        return true;
+
+    // An empty rect means no view has reported its viewport yet, as when a
+    // scene is populated or loaded before it is shown. The widgets in view
+    // are embedded once the first visible rect arrives.
+    QRectF const visible = scene->visibleSceneRect();
+
+    return visible.isEmpty() || !scene->nodeSceneRect(_nodeId).intersects(visible);
+}
+
+bool NodeGraphicsObject::embeddedWidgetResized()
+{
+    QSize size;
+
+    if (_proxyWidget && _proxyWidget->widget())
+        size = _proxyWidget->widget()->size();
+
+    bool const resized = (size != _embeddedWidgetSize);
+
+    _embeddedWidgetSize = size;
+
+    return resized;
+}
+
 void NodeGraphicsObject::setLockedState()
 {
     NodeFlags flags = _graphModel.nodeFlags(_nodeId);
@@ -119,13 +252,36 @@ void NodeGraphicsObject::setLockedState()
     setFlag(QGraphicsItem::ItemSendsScenePositionChanges, !locked);
 }
 
+NodeStyle const &NodeGraphicsObject::nodeStyle() const
+{
+    unsigned int const version = StyleCollection::nodeStyleVersion();
+
+    if (!_nodeStyle || _nodeStyleVersion != version) {
+        _nodeStyle = _graphModel.nodeStyle(_nodeId);
+        _nodeStyleVersion = version;
+    }
+
+    return *_nodeStyle;
+}
+
 QRectF NodeGraphicsObject::boundingRect() const
 {
     AbstractNodeGeometry &geometry = nodeScene()->nodeGeometry();
-    return geometry.boundingRect(_nodeId);
+
+    QRectF const painted = QRectF(QPointF(0, 0), geometry.size(_nodeId))
+                               .marginsAdded(nodeScene()->nodePainter().paintMargins(*this));
+
+    return geometry.boundingRect(_nodeId).united(painted);
     //return NodeGeometry(_nodeId, _graphModel, nodeScene()).boundingRect();
 }
 
+QPainterPath NodeGraphicsObject::shape() const
+{
+    QPainterPath path;
+    path.addRect(nodeScene()->nodeGeometry().boundingRect(_nodeId));
+    return path;
+}
+
 void NodeGraphicsObject::setGeometryChanged()
 {
     prepareGeometryChange();
@@ -133,14 +289,11 @@ void NodeGraphicsObject::setGeometryChanged()
 
 void NodeGraphicsObject::moveConnections() const
 {
-    auto const &connected = _graphModel.allConnectionIds(_nodeId);
-
-    for (auto &cnId : connected) {
-        auto cgo = nodeScene()->connectionGraphicsObject(cnId);
+    PaintCounters::add(PaintCounters::MoveConnectionsCalls);
 
-        if (cgo)
-            cgo->move();
-    }
+    // Coalesced by the scene: several nodes moving in one event loop turn
+    // recompute each shared connection once.
+    nodeScene()->scheduleConnectionUpdate(_nodeId);
 }
 
 void NodeGraphicsObject::reactToConnection(ConnectionGraphicsObject const *cgo)
@@ -150,11 +303,76 @@ void NodeGraphicsObject::reactToConnection(ConnectionGraphicsObject const *cgo)
     update();
 }
 
+void NodeGraphicsObject::applyLevelOfDetail(LevelOfDetail lod)
+{
+    if (auto effect = graphicsEffect())
+        effect->setEnabled(lod == LevelOfDetail::Full);
+
+    updateEmbeddedWidgetVisibility();
+}
+
+void NodeGraphicsObject::updateEmbeddedWidgetVisibility()
+{
+    if (_embeddedWidgetPending && !embeddedWidgetDeferred()) {
+        embedQWidget();
+
+        // The real widget may differ from the size hint.
+        if (_proxyWidget)
+            nodeScene()->onNodeUpdated(_nodeId);
+    }
+
+    if (!_proxyWidget)
+        return;
+
+    BasicGraphicsScene *scene = nodeScene();
+
+    bool live = (scene->levelOfDetail() == LevelOfDetail::Full);
+
+    if (live && scene->widgetSnapshotsEnabled()) {
+        live = _nodeState.hovered() || _proxyWidget->hasFocus();
+    }
+
+    if (_proxyWidget->isVisible() == live)
+        return;
+
+    // The widget may have changed while it was live.
+    if (!live)
+        invalidateWidgetSnapshot();
+
+    _proxyWidget->setVisible(live);
+
+    update();
+}
+
+void NodeGraphicsObject::invalidateWidgetSnapshot()
+{
+    _widgetSnapshot = QPixmap();
+}
+
 void NodeGraphicsObject::paint(QPainter *painter, QStyleOptionGraphicsItem const *option, QWidget *)
 {
+    PaintCounters::add(PaintCounters::NodePaints);
+
     painter->setClipRect(option->exposedRect);
 
-    nodeScene()->nodePainter().paint(painter, *this);
+    double const scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform());
+
+    LevelOfDetail const lod = StyleCollection::flowViewStyle().levelOfDetail(scale);
+
+    nodeScene()->nodePainter().paintWithDetail(painter, *this, lod);
+
+    if (lod == LevelOfDetail::Full && _proxyWidget && !_proxyWidget->isVisible()
+        && nodeScene()->widgetSnapshotsEnabled()) {
+        if (QWidget *w = _proxyWidget->widget()) {
+            if (_widgetSnapshot.isNull())
+                _widgetSnapshot = w->grab();
+
+            painter->drawPixmap(QRectF(_proxyWidget->pos(), _proxyWidget->size()),
+                                _widgetSnapshot,
+                                QRectF(_widgetSnapshot.rect()));
+        }
+    }
 }
 
 QVariant NodeGraphicsObject::itemChange(GraphicsItemChange change, const QVariant &value)
@@ -209,13 +427,14 @@ void NodeGraphicsObject::mousePressEvent(QGraphicsSceneMouseEvent *event)
             auto const &cnId = *connected.begin();
 
             // Need ConnectionGraphicsObject
+            auto cgo = nodeScene()->materializeConnection(cnId);
 
-            NodeConnectionInteraction interaction(*this,
-                                                  *nodeScene()->connectionGraphicsObject(cnId),
-                                                  *nodeScene());
+            if (cgo) {
+                NodeConnectionInteraction interaction(*this, *cgo, *nodeScene());
 
-            if (_graphModel.detachPossible(cnId))
-                interaction.disconnect(portToCheck);
+                if (_graphModel.detachPossible(cnId))
+                    interaction.disconnect(portToCheck);
+            }
         } else // initialize new Connection
         {
             if (portToCheck == PortType::Out) {
@@ -283,6 +502,8 @@ void NodeGraphicsObject::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
             // Passes the new size to the model.
             geometry.recomputeSize(_nodeId);
 
+            nodeScene()->updateNodeIndex(_nodeId);
+
             update();
 
             moveConnections();
@@ -318,20 +539,13 @@ void NodeGraphicsObject::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 
 void NodeGraphicsObject::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 {
-    // bring all the colliding nodes to background
-    QList<QGraphicsItem *> overlapItems = collidingItems();
-
-    for (QGraphicsItem *item : overlapItems) {
-        if (item->zValue() > 0.0) {
-            item->setZValue(0.0);
-        }
-    }
-
-    // bring this node forward
-    setZValue(1.0);
+    // bring this node forward; the previously raised node goes back
+    nodeScene()->raiseNode(_nodeId);
 
     _nodeState.setHovered(true);
 
+    updateEmbeddedWidgetVisibility();
+
     update();
 
     Q_EMIT nodeScene()->nodeHovered(_nodeId, event->screenPos());
@@ -343,7 +557,9 @@ void NodeGraphicsObject::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
 {
     _nodeState.setHovered(false);
 
-    setZValue(0.0);
+    updateEmbeddedWidgetVisibility();
+
+    nodeScene()->lowerNode(_nodeId);
 
     update();
 
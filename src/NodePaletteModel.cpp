@@ -0,0 +1,283 @@
+#include "NodePaletteModel.hpp"
+
+#include "NodeDelegateModelRegistry.hpp"
+#include "Trigrams.hpp"
+
+#include <QtGui/QFont>
+
+#include <algorithm>
+#include <utility>
+
+namespace QtNodes {
+
+namespace {
+
+// Scores of the match classes; fuzzy matches score their similarity below 1.
+double const ExactScore = 5.0;
+double const NamePrefixScore = 4.0;
+double const WordPrefixScore = 3.0;
+double const SubstringScore = 2.0;
+
+/// Case-folded words of a model name. Words are runs of letters and digits,
+/// and a capital letter after a lower-case one starts a new word, so that
+/// "NumberSource" is found by "source".
+std::vector<QString> words(QString const &name)
+{
+    std::vector<QString> result;
+
+    int start = -1;
+
+    for (int i = 0; i <= name.size(); ++i) {
+        bool const inWord = i < name.size() && name[i].isLetterOrNumber();
+
+        bool const camelBreak = inWord && start >= 0 && name[i].isUpper()
+                                && name[i - 1].isLower();
+
+        if (start >= 0 && (!inWord || camelBreak)) {
+            result.push_back(name.mid(start, i - start).toCaseFolded());
+            start = -1;
+        }
+
+        if (inWord && start < 0)
+            start = i;
+    }
+
+    return result;
+}
+
+} // namespace
+
+NodePaletteModel::NodePaletteModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , _registry(nullptr)
+    , _registryVersion(0)
+{}
+
+void NodePaletteModel::update(NodeDelegateModelRegistry const &registry)
+{
+    if (_registry == &registry && _registryVersion == registry.version())
+        return;
+
+    rebuild(registry);
+}
+
+void NodePaletteModel::setFilter(QString const &filter)
+{
+    QString const folded = filter.trimmed().toCaseFolded();
+
+    if (folded == _filter)
+        return;
+
+    beginResetModel();
+
+    _filter = folded;
+    _rows = rows(_filter);
+
+    endResetModel();
+}
+
+int NodePaletteModel::rowCount(QModelIndex const &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(_rows.size());
+}
+
+QVariant NodePaletteModel::data(QModelIndex const &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(_rows.size()))
+        return QVariant();
+
+    int const row = _rows[index.row()];
+
+    if (row < 0) {
+        switch (role) {
+        case Qt::DisplayRole:
+            return _categories[-1 - row];
+
+        case Qt::FontRole: {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+
+        default:
+            return QVariant();
+        }
+    }
+
+    Entry const &entry = _entries[row];
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case ModelNameRole:
+        return entry.name;
+
+    case Qt::ToolTipRole:
+        return _categories[entry.category];
+
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags NodePaletteModel::flags(QModelIndex const &index) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(_rows.size()))
+        return Qt::NoItemFlags;
+
+    if (_rows[index.row()] < 0)
+        return Qt::ItemIsEnabled;
+
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+void NodePaletteModel::rebuild(NodeDelegateModelRegistry const &registry)
+{
+    beginResetModel();
+
+    _registry = &registry;
+    _registryVersion = registry.version();
+
+    _categories.clear();
+    _entries.clear();
+    _words.clear();
+    _trigrams.clear();
+
+    auto const &associations = registry.registeredModelsCategoryAssociation();
+
+    // (category, name)
+    std::vector<std::pair<QString, QString>> models;
+    models.reserve(associations.size());
+
+    for (auto const &assoc : associations)
+        models.emplace_back(assoc.second, assoc.first);
+
+    std::sort(models.begin(), models.end());
+
+    _entries.reserve(models.size());
+
+    for (auto const &model : models) {
+        if (_categories.empty() || _categories.back() != model.first)
+            _categories.push_back(model.first);
+
+        int const index = static_cast<int>(_entries.size());
+
+        Entry entry;
+        entry.name = model.second;
+        entry.category = static_cast<int>(_categories.size()) - 1;
+        entry.folded = model.second.toCaseFolded();
+
+        std::vector<QString> nameWords = words(entry.name);
+        std::sort(nameWords.begin(), nameWords.end());
+        nameWords.erase(std::unique(nameWords.begin(), nameWords.end()), nameWords.end());
+
+        for (QString const &word : nameWords)
+            _words[word].push_back(index);
+
+        std::vector<quint64> const nameTrigrams = trigrams(entry.folded);
+
+        for (quint64 const trigram : nameTrigrams)
+            _trigrams[trigram].push_back(index);
+
+        entry.trigramCount = static_cast<int>(nameTrigrams.size());
+
+        _entries.push_back(std::move(entry));
+    }
+
+    _rows = rows(_filter);
+
+    endResetModel();
+}
+
+std::vector<int> NodePaletteModel::rows(QString const &filter) const
+{
+    std::vector<int> result;
+
+    if (filter.isEmpty()) {
+        result.reserve(_entries.size() + _categories.size());
+
+        for (std::size_t i = 0; i < _entries.size(); ++i) {
+            int const category = _entries[i].category;
+
+            if (i == 0 || _entries[i - 1].category != category)
+                result.push_back(-1 - category);
+
+            result.push_back(static_cast<int>(i));
+        }
+
+        return result;
+    }
+
+    std::vector<double> scores(_entries.size(), 0.0);
+
+    auto raise = [&scores](int const entry, double const score) {
+        scores[entry] = std::max(scores[entry], score);
+    };
+
+    // Words starting with the filter follow it in the sorted map.
+    for (auto it = _words.lower_bound(filter); it != _words.end() && it->first.startsWith(filter);
+         ++it) {
+        double const score = WordPrefixScore + double(filter.size()) / it->first.size();
+
+        for (int const entry : it->second)
+            raise(entry, score);
+    }
+
+    std::vector<quint64> const filterTrigrams = trigrams(filter);
+
+    std::vector<int> shared(_entries.size(), 0);
+    std::vector<int> candidates;
+
+    for (quint64 const trigram : filterTrigrams) {
+        auto it = _trigrams.find(trigram);
+
+        if (it == _trigrams.end())
+            continue;
+
+        for (int const entry : it->second) {
+            if (shared[entry]++ == 0)
+                candidates.push_back(entry);
+        }
+    }
+
+    // A name containing a filter of three or more characters shares its inner
+    // trigrams. Shorter filters have none, so every name is a candidate.
+    if (filter.size() < 3) {
+        candidates.resize(_entries.size());
+
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+            candidates[i] = static_cast<int>(i);
+    }
+
+    for (int const candidate : candidates) {
+        Entry const &entry = _entries[candidate];
+
+        if (entry.folded == filter) {
+            raise(candidate, ExactScore);
+        } else if (entry.folded.startsWith(filter)) {
+            raise(candidate, NamePrefixScore + double(filter.size()) / entry.folded.size());
+        } else if (entry.folded.contains(filter)) {
+            raise(candidate, SubstringScore);
+        } else {
+            double const similarity = trigramSimilarity(shared[candidate],
+                                                        filterTrigrams.size(),
+                                                        entry.trigramCount);
+
+            if (similarity >= MinTrigramSimilarity)
+                raise(candidate, similarity);
+        }
+    }
+
+    for (std::size_t i = 0; i < scores.size(); ++i) {
+        if (scores[i] > 0.0)
+            result.push_back(static_cast<int>(i));
+    }
+
+    // Equal scores keep the category and name order.
+    std::stable_sort(result.begin(), result.end(), [&scores](int const a, int const b) {
+        return scores[a] > scores[b];
+    });
+
+    return result;
+}
+
+} // namespace QtNodes
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QString>
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace QtNodes {
+
+class NodeDelegateModelRegistry;
+
+/// Flat list of the registered node models for the scene context menu.
+///
+/// Without a filter the rows are the categories, each followed by its models
+/// sorted by name. With a filter the rows are the matching models ranked by
+/// relevance: the whole name, then the start of a word, then any substring,
+/// then names that merely look alike by their trigrams.
+///
+/// The word and trigram indexes are built once per registry version, so
+/// opening the menu and typing into the filter never walk the registry.
+class NodePaletteModel : public QAbstractListModel
+{
+public:
+    enum Roles {
+        /// Registered name of the model; empty for category rows.
+        ModelNameRole = Qt::UserRole
+    };
+
+    NodePaletteModel(QObject *parent = nullptr);
+
+public:
+    /// Re-reads the registry unless it has not changed since the last call.
+    void update(NodeDelegateModelRegistry const &registry);
+
+    void setFilter(QString const &filter);
+
+public:
+    int rowCount(QModelIndex const &parent = QModelIndex()) const override;
+
+    QVariant data(QModelIndex const &index, int role = Qt::DisplayRole) const override;
+
+    Qt::ItemFlags flags(QModelIndex const &index) const override;
+
+private:
+    struct Entry
+    {
+        QString name;
+
+        int category;
+
+        /// Case-folded name the filter is matched against.
+        QString folded;
+
+        int trigramCount;
+    };
+
+    void rebuild(NodeDelegateModelRegistry const &registry);
+
+    /// Rows shown for the folded filter.
+    std::vector<int> rows(QString const &filter) const;
+
+private:
+    NodeDelegateModelRegistry const *_registry;
+
+    std::size_t _registryVersion;
+
+    std::vector<QString> _categories;
+
+    /// Sorted by category, then by name.
+    std::vector<Entry> _entries;
+
+    /// Words of the folded names, sorted for prefix lookups.
+    std::map<QString, std::vector<int>> _words;
+
+    /// Trigram to the entries containing it, in ascending order.
+    std::unordered_map<quint64, std::vector<int>> _trigrams;
+
+    QString _filter;
+
+    /// Shown rows: entry indices, or -1 - category for category rows.
+    std::vector<int> _rows;
+};
+
+} // namespace QtNodes
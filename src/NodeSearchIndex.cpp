@@ -0,0 +1,267 @@
+#include "NodeSearchIndex.hpp"
+
+#include "AbstractGraphModel.hpp"
+#include "Trigrams.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace QtNodes {
+
+namespace {
+
+// Scores of the match classes; fuzzy matches score their similarity below 1.
+double const ExactScore = 3.0;
+double const PrefixScore = 2.0;
+
+/// Runs of letters and digits.
+QStringList words(QString const &text)
+{
+    QStringList result;
+
+    int start = -1;
+
+    for (int i = 0; i <= text.size(); ++i) {
+        bool const inWord = i < text.size() && text[i].isLetterOrNumber();
+
+        if (inWord && start < 0) {
+            start = i;
+        } else if (!inWord && start >= 0) {
+            result.append(text.mid(start, i - start));
+            start = -1;
+        }
+    }
+
+    return result;
+}
+
+} // namespace
+
+NodeSearchIndex::NodeSearchIndex(AbstractGraphModel &graphModel, QObject *parent)
+    : QObject(parent)
+    , _graphModel(graphModel)
+{
+    connect(&_graphModel, &AbstractGraphModel::nodeCreated, this, &NodeSearchIndex::indexNode);
+    connect(&_graphModel, &AbstractGraphModel::nodeUpdated, this, &NodeSearchIndex::indexNode);
+    connect(&_graphModel, &AbstractGraphModel::nodeDeleted, this, &NodeSearchIndex::removeNode);
+    connect(&_graphModel, &AbstractGraphModel::modelReset, this, &NodeSearchIndex::rebuild);
+
+    rebuild();
+}
+
+QStringList NodeSearchIndex::tags(NodeId const nodeId) const
+{
+    auto it = _entries.find(nodeId);
+
+    return (it != _entries.end()) ? it->second.tags : QStringList();
+}
+
+void NodeSearchIndex::setTags(NodeId const nodeId, QStringList const &tags)
+{
+    if (!_graphModel.nodeExists(nodeId))
+        return;
+
+    _entries[nodeId].tags = tags;
+
+    indexNode(nodeId);
+}
+
+std::vector<NodeId> NodeSearchIndex::search(QString const &query, std::size_t maxResults) const
+{
+    QString const q = query.trimmed().toCaseFolded();
+
+    if (q.isEmpty() || maxResults == 0)
+        return {};
+
+    std::unordered_map<NodeId, double> scores;
+
+    auto addNodes = [&scores](std::unordered_set<NodeId> const &nodes, double score) {
+        for (NodeId const nodeId : nodes) {
+            double &s = scores[nodeId];
+            s = std::max(s, score);
+        }
+    };
+
+    // Terms starting with the query follow it in the sorted map.
+    for (auto it = _terms.lower_bound(q); it != _terms.end() && it->first.startsWith(q); ++it) {
+        double const score = (it->first.size() == q.size())
+                                 ? ExactScore
+                                 : PrefixScore + double(q.size()) / it->first.size();
+
+        addNodes(it->second.nodes, score);
+    }
+
+    std::vector<quint64> const queryTrigrams = trigrams(q);
+
+    std::unordered_map<QString, int> shared;
+
+    for (quint64 const trigram : queryTrigrams) {
+        auto it = _trigrams.find(trigram);
+
+        if (it == _trigrams.end())
+            continue;
+
+        for (QString const &term : it->second)
+            ++shared[term];
+    }
+
+    for (auto const &candidate : shared) {
+        Term const &term = _terms.at(candidate.first);
+
+        double const similarity = trigramSimilarity(candidate.second,
+                                                    queryTrigrams.size(),
+                                                    term.trigramCount);
+
+        if (similarity >= MinTrigramSimilarity)
+            addNodes(term.nodes, similarity);
+    }
+
+    std::vector<std::pair<double, NodeId>> ranked;
+    ranked.reserve(scores.size());
+
+    for (auto const &s : scores)
+        ranked.emplace_back(-s.second, s.first);
+
+    std::size_t const count = std::min(maxResults, ranked.size());
+
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end());
+
+    std::vector<NodeId> result;
+    result.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+        result.push_back(ranked[i].second);
+
+    return result;
+}
+
+void NodeSearchIndex::indexNode(NodeId const nodeId)
+{
+    if (!_graphModel.nodeExists(nodeId))
+        return;
+
+    Entry &entry = _entries[nodeId];
+
+    std::vector<QString> terms = collectTerms(nodeId, entry.tags);
+
+    // Most updates are data changes that leave caption and type alone.
+    if (terms == entry.terms)
+        return;
+
+    for (QString const &term : entry.terms)
+        removeTerm(term, nodeId);
+
+    for (QString const &term : terms)
+        addTerm(term, nodeId);
+
+    entry.terms = std::move(terms);
+}
+
+void NodeSearchIndex::removeNode(NodeId const nodeId)
+{
+    auto it = _entries.find(nodeId);
+
+    if (it == _entries.end())
+        return;
+
+    for (QString const &term : it->second.terms)
+        removeTerm(term, nodeId);
+
+    _entries.erase(it);
+}
+
+void NodeSearchIndex::rebuild()
+{
+    std::unordered_map<NodeId, Entry> previous;
+    previous.swap(_entries);
+
+    _terms.clear();
+    _trigrams.clear();
+
+    for (NodeId const nodeId : _graphModel.allNodeIds()) {
+        auto it = previous.find(nodeId);
+
+        if (it != previous.end())
+            _entries[nodeId].tags = it->second.tags;
+
+        indexNode(nodeId);
+    }
+}
+
+std::vector<QString> NodeSearchIndex::collectTerms(NodeId const nodeId,
+                                                   QStringList const &tags) const
+{
+    std::vector<QString> terms;
+
+    auto add = [&terms](QString const &text) {
+        QString const folded = text.trimmed().toCaseFolded();
+
+        if (folded.isEmpty())
+            return;
+
+        terms.push_back(folded);
+
+        // Each word of a multi-word caption is found on its own.
+        for (QString const &word : words(folded))
+            terms.push_back(word);
+    };
+
+    add(_graphModel.nodeData(nodeId, NodeRole::Caption).toString());
+    add(_graphModel.nodeData(nodeId, NodeRole::Type).toString());
+
+    for (QString const &tag : tags)
+        add(tag);
+
+    terms.push_back(QString::number(nodeId));
+
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    return terms;
+}
+
+void NodeSearchIndex::addTerm(QString const &term, NodeId const nodeId)
+{
+    auto it = _terms.find(term);
+
+    if (it == _terms.end()) {
+        std::vector<quint64> const termTrigrams = trigrams(term);
+
+        it = _terms.emplace(term, Term()).first;
+        it->second.trigramCount = termTrigrams.size();
+
+        for (quint64 const trigram : termTrigrams)
+            _trigrams[trigram].insert(term);
+    }
+
+    it->second.nodes.insert(nodeId);
+}
+
+void NodeSearchIndex::removeTerm(QString const &term, NodeId const nodeId)
+{
+    auto it = _terms.find(term);
+
+    if (it == _terms.end())
+        return;
+
+    it->second.nodes.erase(nodeId);
+
+    if (!it->second.nodes.empty())
+        return;
+
+    _terms.erase(it);
+
+    for (quint64 const trigram : trigrams(term)) {
+        auto t = _trigrams.find(trigram);
+
+        if (t == _trigrams.end())
+            continue;
+
+        t->second.erase(term);
+
+        if (t->second.empty())
+            _trigrams.erase(t);
+    }
+}
+
+} // namespace QtNodes
@@ -0,0 +1,23 @@
+#include "PaintCounters.hpp"
+
+#include <atomic>
+
+namespace QtNodes {
+
+namespace {
+
+std::atomic<quint64> counters[PaintCounters::CounterCount];
+
+} // namespace
+
+void PaintCounters::add(Counter counter, quint64 n)
+{
+    counters[counter].fetch_add(n, std::memory_order_relaxed);
+}
+
+quint64 PaintCounters::value(Counter counter)
+{
+    return counters[counter].load(std::memory_order_relaxed);
+}
+
+} // namespace QtNodes
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QtCore/QtGlobal>
+
+namespace QtNodes {
+
+/// Process-wide counters of paint and layout work. GraphicsView reads them
+/// around each frame to attribute frame time; each hook is a relaxed atomic
+/// add. The counters are shared by all views and by SceneRasterizer, so a
+/// view only attributes the paint counts taken during its own paintEvent.
+class PaintCounters
+{
+public:
+    enum Counter {
+        NodePaints,
+        ConnectionPaints,
+        RecomputeSizeCalls,
+        MoveConnectionsCalls,
+        CounterCount
+    };
+
+    static void add(Counter counter, quint64 n = 1);
+
+    static quint64 value(Counter counter);
+};
+
+} // namespace QtNodes
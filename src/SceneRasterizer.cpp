@@ -0,0 +1,301 @@
+#include "SceneRasterizer.hpp"
+
+#include "BasicGraphicsScene.hpp"
+#include "StyleCollection.hpp"
+
+#include <QtCore/QRunnable>
+#include <QtCore/QString>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtMath>
+#include <QtGui/QPainter>
+#include <QtGui/QPicture>
+
+#ifdef NODE_EDITOR_HAS_SVG
+#include <QtSvg/QSvgGenerator>
+#endif
+
+#include <deque>
+#include <future>
+#include <utility>
+
+namespace QtNodes {
+
+namespace {
+
+void setRenderHints(QPainter &painter)
+{
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+}
+
+QImage createTile(QSize const &size, QColor const &background)
+{
+    QImage tile(size, QImage::Format_ARGB32_Premultiplied);
+    tile.fill(background);
+    return tile;
+}
+
+/// Plays a recorded tile back into an image on a pool thread.
+class TileJob : public QRunnable
+{
+public:
+    TileJob(QPicture picture, QSize const &size, QColor const &background)
+        : _picture(std::move(picture))
+        , _size(size)
+        , _background(background)
+    {}
+
+    std::future<QImage> result() { return _promise.get_future(); }
+
+    void run() override
+    {
+        QImage tile = createTile(_size, _background);
+
+        // Same DPI as the recording, so fonts are not rescaled on playback.
+        tile.setDotsPerMeterX(qRound(_picture.logicalDpiX() / 0.0254));
+        tile.setDotsPerMeterY(qRound(_picture.logicalDpiY() / 0.0254));
+
+        QPainter painter(&tile);
+        setRenderHints(painter);
+        painter.drawPicture(0, 0, _picture);
+        painter.end();
+
+        _promise.set_value(std::move(tile));
+    }
+
+private:
+    QPicture _picture;
+    QSize _size;
+    QColor _background;
+
+    std::promise<QImage> _promise;
+};
+
+} // namespace
+
+SceneRasterizer::SceneRasterizer(BasicGraphicsScene &scene)
+    : _scene(scene)
+    , _scale(1.0)
+    , _tileSize(1024)
+    , _threadCount(qMax(1, QThread::idealThreadCount()))
+    , _backgroundColor(StyleCollection::flowViewStyle().BackgroundColor)
+{}
+
+QRectF SceneRasterizer::sourceRect() const
+{
+    if (!_sourceRect.isNull())
+        return _sourceRect;
+
+    // Node rects already include the geometry's margins around the node.
+    return _scene.nodeIndex().boundingRect().united(_scene.connectionIndex().boundingRect());
+}
+
+void SceneRasterizer::setSourceRect(QRectF const &sceneRect)
+{
+    _sourceRect = sceneRect;
+}
+
+void SceneRasterizer::setScale(double scale)
+{
+    _scale = qMax(scale, 0.0);
+}
+
+void SceneRasterizer::setTileSize(int tileSize)
+{
+    _tileSize = qMax(tileSize, 1);
+}
+
+void SceneRasterizer::setThreadCount(int threadCount)
+{
+    _threadCount = qMax(threadCount, 1);
+}
+
+void SceneRasterizer::setBackgroundColor(QColor const &color)
+{
+    _backgroundColor = color;
+}
+
+QSize SceneRasterizer::imageSize() const
+{
+    QRectF const source = sourceRect();
+
+    return QSize(qCeil(source.width() * _scale), qCeil(source.height() * _scale));
+}
+
+bool SceneRasterizer::renderTiles(TileSink const &sink)
+{
+    QSize const size = imageSize();
+
+    if (size.isEmpty())
+        return false;
+
+    QRectF const source = sourceRect();
+
+    _scene.flushConnectionUpdates();
+
+    // Restored when done; the export must not change what the views show.
+    LevelOfDetail const viewLevelOfDetail = _scene.levelOfDetail();
+    QRectF const viewSceneRect = _scene.visibleSceneRect();
+
+    _scene.setLevelOfDetail(StyleCollection::flowViewStyle().levelOfDetail(_scale));
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(_threadCount);
+
+    // Bounds the number of tiles held in memory at any time.
+    std::size_t const maxPending = 2 * static_cast<std::size_t>(_threadCount);
+
+    std::deque<std::pair<QPoint, std::future<QImage>>> pending;
+
+    bool completed = true;
+
+    auto deliverFirst = [&]() {
+        QImage const tile = pending.front().second.get();
+
+        if (completed)
+            completed = sink(pending.front().first, tile);
+
+        pending.pop_front();
+    };
+
+    for (int y = 0; completed && y < size.height(); y += _tileSize) {
+        for (int x = 0; completed && x < size.width(); x += _tileSize) {
+            QSize const tileSize(qMin(_tileSize, size.width() - x),
+                                 qMin(_tileSize, size.height() - y));
+
+            QRectF const tileSceneRect(source.left() + x / _scale,
+                                       source.top() + y / _scale,
+                                       tileSize.width() / _scale,
+                                       tileSize.height() / _scale);
+
+            // Materializes the nodes under the tile in a virtualized scene and
+            // embeds the deferred widgets in it, also without virtualization.
+            _scene.setVisibleSceneRect(tileSceneRect);
+
+            if (_threadCount == 1) {
+                completed = sink(QPoint(x, y), renderTile(tileSceneRect, tileSize));
+                continue;
+            }
+
+            // Items can only be painted on this thread; the recording is
+            // rasterized on the pool.
+            QPicture picture;
+
+            QPainter painter(&picture);
+            setRenderHints(painter);
+            _scene.render(&painter,
+                          QRectF(QPointF(0, 0), tileSize),
+                          tileSceneRect,
+                          Qt::IgnoreAspectRatio);
+            painter.end();
+
+            auto job = new TileJob(std::move(picture), tileSize, _backgroundColor);
+
+            pending.emplace_back(QPoint(x, y), job->result());
+
+            pool.start(job);
+
+            if (pending.size() >= maxPending)
+                deliverFirst();
+        }
+    }
+
+    while (!pending.empty())
+        deliverFirst();
+
+    _scene.setVisibleSceneRect(viewSceneRect);
+
+    _scene.setLevelOfDetail(viewLevelOfDetail);
+
+    return completed;
+}
+
+QImage SceneRasterizer::renderImage()
+{
+    QImage image(imageSize(), QImage::Format_ARGB32_Premultiplied);
+
+    if (image.isNull())
+        return QImage();
+
+    QPainter painter(&image);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+
+    bool const completed = renderTiles([&painter](QPoint const &offset, QImage const &tile) {
+        painter.drawImage(offset, tile);
+        return true;
+    });
+
+    painter.end();
+
+    return completed ? image : QImage();
+}
+
+bool SceneRasterizer::savePng(QString const &fileName)
+{
+    // QImageWriter only encodes whole images, so the tiles are assembled first.
+    QImage const image = renderImage();
+
+    return !image.isNull() && image.save(fileName, "PNG");
+}
+
+bool SceneRasterizer::saveSvg(QString const &fileName)
+{
+#ifdef NODE_EDITOR_HAS_SVG
+    QSize const size = imageSize();
+
+    if (size.isEmpty())
+        return false;
+
+    QRectF const source = sourceRect();
+
+    _scene.flushConnectionUpdates();
+
+    LevelOfDetail const viewLevelOfDetail = _scene.levelOfDetail();
+    QRectF const viewSceneRect = _scene.visibleSceneRect();
+
+    _scene.setLevelOfDetail(StyleCollection::flowViewStyle().levelOfDetail(_scale));
+
+    _scene.setVisibleSceneRect(source);
+
+    QSvgGenerator generator;
+    generator.setFileName(fileName);
+    generator.setSize(size);
+    generator.setViewBox(QRect(QPoint(0, 0), size));
+
+    QPainter painter;
+
+    bool const opened = painter.begin(&generator);
+
+    if (opened) {
+        setRenderHints(painter);
+        painter.fillRect(QRect(QPoint(0, 0), size), _backgroundColor);
+        _scene.render(&painter, QRectF(QPointF(0, 0), size), source, Qt::IgnoreAspectRatio);
+        painter.end();
+    }
+
+    _scene.setVisibleSceneRect(viewSceneRect);
+
+    _scene.setLevelOfDetail(viewLevelOfDetail);
+
+    return opened;
+#else
+    Q_UNUSED(fileName);
+    return false;
+#endif
+}
+
+QImage SceneRasterizer::renderTile(QRectF const &sceneRect, QSize const &size) const
+{
+    QImage tile = createTile(size, _backgroundColor);
+
+    QPainter painter(&tile);
+    setRenderHints(painter);
+    _scene.render(&painter, QRectF(QPointF(0, 0), size), sceneRect, Qt::IgnoreAspectRatio);
+    painter.end();
+
+    return tile;
+}
+
+} // namespace QtNodes
@@ -20,9 +20,34 @@ GraphicsViewStyle const &StyleCollection::flowViewStyle()
     return instance()._flowViewStyle;
 }
 
+std::shared_ptr<NodeStyle const> StyleCollection::sharedNodeStyle()
+{
+    auto &collection = instance();
+
+    if (!collection._sharedNodeStyle)
+        collection._sharedNodeStyle = std::make_shared<NodeStyle const>(collection._nodeStyle);
+
+    return collection._sharedNodeStyle;
+}
+
+unsigned int StyleCollection::nodeStyleVersion()
+{
+    return instance()._nodeStyleVersion;
+}
+
+void StyleCollection::invalidateNodeStyles()
+{
+    ++instance()._nodeStyleVersion;
+}
+
 void StyleCollection::setNodeStyle(NodeStyle nodeStyle)
 {
-    instance()._nodeStyle = nodeStyle;
+    auto &collection = instance();
+
+    collection._nodeStyle = nodeStyle;
+    collection._sharedNodeStyle.reset();
+
+    invalidateNodeStyles();
 }
 
 void StyleCollection::setConnectionStyle(ConnectionStyle connectionStyle)
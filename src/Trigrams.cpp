@@ -0,0 +1,36 @@
+#include "Trigrams.hpp"
+
+#include <algorithm>
+
+namespace QtNodes {
+
+std::vector<quint64> trigrams(QString const &text)
+{
+    QString padded = text;
+    padded.prepend(QLatin1Char(' '));
+    padded.append(QLatin1Char(' '));
+
+    std::vector<quint64> result;
+    result.reserve(padded.size());
+
+    for (int i = 0; i + 2 < padded.size(); ++i) {
+        result.push_back((quint64(padded[i].unicode()) << 32)
+                         | (quint64(padded[i + 1].unicode()) << 16)
+                         | quint64(padded[i + 2].unicode()));
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    return result;
+}
+
+double trigramSimilarity(std::size_t shared, std::size_t countA, std::size_t countB)
+{
+    if (countA + countB == 0)
+        return 0.0;
+
+    return 2.0 * shared / (countA + countB);
+}
+
+} // namespace QtNodes
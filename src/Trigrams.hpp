@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QtCore/QString>
+
+#include <cstddef>
+#include <vector>
+
+namespace QtNodes {
+
+/// Fuzzy matching shared by NodeSearchIndex and NodePaletteModel, so that the
+/// node search and the model palette accept the same near misses.
+
+/// Minimum Dice coefficient of two trigram sets for a fuzzy match.
+double const MinTrigramSimilarity = 0.5;
+
+/// Sorted, distinct trigrams of the text padded with a space on each side, so
+/// that short texts and word boundaries count as well. Each trigram packs its
+/// three UTF-16 code units into one integer.
+std::vector<quint64> trigrams(QString const &text);
+
+/// Dice coefficient of two trigram sets of the given sizes sharing `shared`
+/// trigrams.
+double trigramSimilarity(std::size_t shared, std::size_t countA, std::size_t countB);
+
+} // namespace QtNodes
@@ -65,8 +65,13 @@ static void insertSerializedItems(QJsonObject const &json, BasicGraphicsScene *s
         graphModel.loadNode(obj);
 
         auto id = obj["id"].toInt();
-        scene->nodeGraphicsObject(id)->setZValue(1.0);
-        scene->nodeGraphicsObject(id)->setSelected(true);
+
+        // Pasted nodes stay above the existing ones until the next hover.
+        scene->raiseNode(id, false);
+
+        // Virtualized scenes may not have an object for the node.
+        if (auto ngo = scene->nodeGraphicsObject(id))
+            ngo->setSelected(true);
     }
 
     QJsonArray const &connJsonArray = json["connections"].toArray();
@@ -79,7 +84,8 @@ static void insertSerializedItems(QJsonObject const &json, BasicGraphicsScene *s
         // Restore the connection
         graphModel.addConnection(connId);
 
-        scene->connectionGraphicsObject(connId)->setSelected(true);
+        if (auto cgo = scene->connectionGraphicsObject(connId))
+            cgo->setSelected(true);
     }
 }
 
@@ -459,4 +465,43 @@ bool MoveNodeCommand::mergeWith(QUndoCommand const *c)
     return false;
 }
 
+LayoutCommand::LayoutCommand(BasicGraphicsScene *scene,
+                             std::unordered_map<NodeId, QPointF> newPositions)
+    : _scene(scene)
+    , _newPositions(std::move(newPositions))
+{
+    _oldPositions.reserve(_newPositions.size());
+
+    for (auto const &entry : _newPositions) {
+        _oldPositions[entry.first] = _scene->graphModel().nodeData<QPointF>(entry.first,
+                                                                             NodeRole::Position);
+    }
+}
+
+void LayoutCommand::undo()
+{
+    setPositions(_oldPositions);
+}
+
+void LayoutCommand::redo()
+{
+    setPositions(_newPositions);
+}
+
+void LayoutCommand::setPositions(std::unordered_map<NodeId, QPointF> const &positions)
+{
+    AbstractGraphModel &graphModel = _scene->graphModel();
+
+    for (auto const &entry : positions) {
+        if (graphModel.nodeExists(entry.first))
+            graphModel.setNodeData(entry.first, NodeRole::Position, entry.second);
+    }
+
+    // Most nodes usually move out of view; their graphics objects are released.
+    if (_scene->virtualizationEnabled()) {
+        _scene->flushConnectionUpdates();
+        _scene->setVisibleSceneRect(_scene->visibleSceneRect());
+    }
+}
+
 } // namespace QtNodes
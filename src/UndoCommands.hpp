@@ -6,6 +6,7 @@
 #include <QtCore/QJsonObject>
 #include <QtCore/QPointF>
 
+#include <unordered_map>
 #include <unordered_set>
 
 namespace QtNodes {
@@ -120,4 +121,25 @@ private:
     QPointF _diff;
 };
 
+/**
+ * Moves many nodes to new positions at once, e.g. after an automatic layout.
+ * The previous positions are taken when the command is created.
+ */
+class LayoutCommand : public QUndoCommand
+{
+public:
+    LayoutCommand(BasicGraphicsScene *scene, std::unordered_map<NodeId, QPointF> newPositions);
+
+    void undo() override;
+    void redo() override;
+
+private:
+    void setPositions(std::unordered_map<NodeId, QPointF> const &positions);
+
+private:
+    BasicGraphicsScene *_scene;
+    std::unordered_map<NodeId, QPointF> _oldPositions;
+    std::unordered_map<NodeId, QPointF> _newPositions;
+};
+
 } // namespace QtNodes
@@ -5,6 +5,7 @@
 #include <QtCore/QList>
 #include <QtWidgets/QGraphicsScene>
 
+#include "BasicGraphicsScene.hpp"
 #include "NodeGraphicsObject.hpp"
 
 namespace QtNodes {
@@ -13,6 +14,26 @@ NodeGraphicsObject *locateNodeAt(QPointF scenePoint,
                                  QGraphicsScene &scene,
                                  QTransform const &viewTransform)
 {
+    // Node scenes answer from their spatial index instead of testing every
+    // item. Overlapping nodes mostly share a z value, so only the scene
+    // knows which one is on top; those rare cases fall through to it.
+    if (auto nodeScene = dynamic_cast<BasicGraphicsScene *>(&scene)) {
+        NodeGraphicsObject *node = nullptr;
+        int hits = 0;
+
+        for (NodeId const nodeId : nodeScene->nodesAt(scenePoint)) {
+            NodeGraphicsObject *ngo = nodeScene->nodeGraphicsObject(nodeId);
+
+            if (ngo && ngo->isVisible() && ngo->contains(ngo->mapFromScene(scenePoint))) {
+                node = ngo;
+                ++hits;
+            }
+        }
+
+        if (hits < 2)
+            return node;
+    }
+
     // items under cursor
     QList<QGraphicsItem *> items = scene.items(scenePoint,
                                                Qt::IntersectsItemShape,
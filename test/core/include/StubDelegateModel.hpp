@@ -0,0 +1,41 @@
+#pragma once
+
+#include <utility>
+
+#include <QtNodes/NodeDelegateModel>
+
+/// Portless delegate model whose name and caption are set at registration.
+class StubDelegateModel : public QtNodes::NodeDelegateModel
+{
+public:
+    StubDelegateModel(QString name, QString caption)
+        : _name(std::move(name))
+        , _caption(std::move(caption))
+    {}
+
+    QString name() const override { return _name; }
+
+    QString caption() const override { return _caption; }
+
+    unsigned int nPorts(QtNodes::PortType) const override { return 0; }
+
+    QtNodes::NodeDataType dataType(QtNodes::PortType, QtNodes::PortIndex) const override
+    {
+        return QtNodes::NodeDataType();
+    }
+
+    void setInData(std::shared_ptr<QtNodes::NodeData>, QtNodes::PortIndex const) override {}
+
+    std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex const) override
+    {
+        return nullptr;
+    }
+
+    QWidget *embeddedWidget() override { return nullptr; }
+
+    QWidget *detailedSettingsWidget() override { return nullptr; }
+
+private:
+    QString _name;
+    QString _caption;
+};
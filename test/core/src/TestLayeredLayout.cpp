@@ -0,0 +1,207 @@
+#include <QtNodes/LayeredLayout>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+using QtNodes::LayeredLayout;
+
+namespace {
+
+double const LayerSpacing = 80.0;
+double const NodeSpacing = 30.0;
+
+LayeredLayout::Graph graph(int nodeCount, std::vector<std::pair<int, int>> edges)
+{
+    LayeredLayout::Graph g;
+    g.sizes.assign(nodeCount, QSizeF(100, 50));
+    g.edges = std::move(edges);
+    return g;
+}
+
+std::vector<QPointF> layout(LayeredLayout::Graph const &g,
+                            Qt::Orientation orientation = Qt::Horizontal)
+{
+    std::atomic<bool> canceled(false);
+
+    return LayeredLayout::computePositions(g, orientation, LayerSpacing, NodeSpacing, canceled);
+}
+
+/// Center of a node along the layer axis: x in horizontal layouts, y in vertical ones.
+double layerCoordinate(LayeredLayout::Graph const &g,
+                       std::vector<QPointF> const &positions,
+                       int v,
+                       Qt::Orientation orientation)
+{
+    return orientation == Qt::Horizontal ? positions[v].x() + g.sizes[v].width() / 2
+                                         : positions[v].y() + g.sizes[v].height() / 2;
+}
+
+/// Center of a node within its layer.
+double orderCoordinate(LayeredLayout::Graph const &g,
+                       std::vector<QPointF> const &positions,
+                       int v,
+                       Qt::Orientation orientation)
+{
+    return orientation == Qt::Horizontal ? positions[v].y() + g.sizes[v].height() / 2
+                                         : positions[v].x() + g.sizes[v].width() / 2;
+}
+
+bool overlapping(LayeredLayout::Graph const &g, std::vector<QPointF> const &positions)
+{
+    for (std::size_t a = 0; a < positions.size(); ++a) {
+        for (std::size_t b = a + 1; b < positions.size(); ++b) {
+            if (QRectF(positions[a], g.sizes[a]).intersects(QRectF(positions[b], g.sizes[b])))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+bool alignedToOrigin(std::vector<QPointF> const &positions)
+{
+    double minX = positions.front().x();
+    double minY = positions.front().y();
+
+    for (QPointF const &p : positions) {
+        minX = std::min(minX, p.x());
+        minY = std::min(minY, p.y());
+    }
+
+    return minX == Approx(0.0) && minY == Approx(0.0);
+}
+
+} // namespace
+
+TEST_CASE("LayeredLayout places chains layer by layer", "[layout]")
+{
+    auto const g = graph(3, {{0, 1}, {1, 2}});
+
+    SECTION("horizontal")
+    {
+        auto const positions = layout(g, Qt::Horizontal);
+
+        REQUIRE(positions.size() == 3);
+        CHECK(positions[0] == QPointF(0, 0));
+        CHECK(positions[1] == QPointF(100 + LayerSpacing, 0));
+        CHECK(positions[2] == QPointF(2 * (100 + LayerSpacing), 0));
+    }
+
+    SECTION("vertical")
+    {
+        auto const positions = layout(g, Qt::Vertical);
+
+        REQUIRE(positions.size() == 3);
+        CHECK(positions[0] == QPointF(0, 0));
+        CHECK(positions[1] == QPointF(0, 50 + LayerSpacing));
+        CHECK(positions[2] == QPointF(0, 2 * (50 + LayerSpacing)));
+    }
+}
+
+TEST_CASE("LayeredLayout handles degenerate graphs", "[layout]")
+{
+    SECTION("empty graph")
+    {
+        CHECK(layout(graph(0, {})).empty());
+    }
+
+    SECTION("self-loops are ignored")
+    {
+        CHECK(layout(graph(1, {{0, 0}})) == std::vector<QPointF>{QPointF(0, 0)});
+        CHECK(layout(graph(2, {{0, 0}, {0, 1}, {1, 1}})) == layout(graph(2, {{0, 1}})));
+    }
+
+    SECTION("duplicate edges count once")
+    {
+        auto const once = layout(graph(4, {{0, 1}, {0, 2}, {1, 3}, {2, 3}}));
+        auto const twice = layout(graph(4, {{2, 3}, {0, 1}, {0, 2}, {0, 1}, {1, 3}, {2, 3}}));
+
+        CHECK(once == twice);
+    }
+
+    SECTION("cycles are broken")
+    {
+        auto const g = graph(3, {{0, 1}, {1, 2}, {2, 0}});
+        auto const positions = layout(g);
+
+        REQUIRE(positions.size() == 3);
+        CHECK(positions[0].x() == Approx(0.0));
+        CHECK(positions[1].x() == Approx(100 + LayerSpacing));
+        CHECK(positions[2].x() == Approx(2 * (100 + LayerSpacing)));
+        CHECK_FALSE(overlapping(g, positions));
+    }
+
+    SECTION("disconnected nodes share the first layer")
+    {
+        auto const g = graph(6, {{4, 5}});
+        auto const positions = layout(g);
+
+        REQUIRE(positions.size() == 6);
+
+        for (int v = 0; v < 5; ++v)
+            CHECK(positions[v].x() == Approx(0.0));
+
+        CHECK(positions[5].x() == Approx(100 + LayerSpacing));
+        CHECK_FALSE(overlapping(g, positions));
+        CHECK(alignedToOrigin(positions));
+    }
+
+    SECTION("canceled")
+    {
+        std::atomic<bool> canceled(true);
+
+        CHECK(LayeredLayout::computePositions(graph(3, {{0, 1}, {1, 2}}),
+                                              Qt::Horizontal,
+                                              LayerSpacing,
+                                              NodeSpacing,
+                                              canceled)
+                  .empty());
+    }
+}
+
+TEST_CASE("LayeredLayout orders layers without needless crossings", "[layout]")
+{
+    // A binary tree, each level of which can be ordered without crossings.
+    auto g = graph(7, {{0, 1}, {0, 2}, {1, 3}, {1, 4}, {2, 5}, {2, 6}});
+
+    // An edge skipping a layer and nodes of different sizes.
+    g.edges.emplace_back(0, 6);
+    g.sizes[3] = QSizeF(160, 90);
+
+    for (Qt::Orientation orientation : {Qt::Horizontal, Qt::Vertical}) {
+        auto const positions = layout(g, orientation);
+
+        REQUIRE(positions.size() == 7);
+        CHECK_FALSE(overlapping(g, positions));
+        CHECK(alignedToOrigin(positions));
+
+        auto const layerOf = [&](int v) { return layerCoordinate(g, positions, v, orientation); };
+        auto const orderOf = [&](int v) { return orderCoordinate(g, positions, v, orientation); };
+
+        // Every edge points to a later layer.
+        for (auto const &e : g.edges)
+            CHECK(layerOf(e.second) > layerOf(e.first));
+
+        // Tree edges between the same pair of layers do not cross.
+        std::vector<std::pair<int, int>> const treeEdges(g.edges.begin(), g.edges.begin() + 6);
+
+        for (auto const &a : treeEdges) {
+            for (auto const &b : treeEdges) {
+                if (a.first == b.first || a.second == b.second)
+                    continue;
+
+                if (layerOf(a.first) != Approx(layerOf(b.first)))
+                    continue;
+
+                double const from = orderOf(a.first) - orderOf(b.first);
+                double const to = orderOf(a.second) - orderOf(b.second);
+
+                CHECK(from * to > 0);
+            }
+        }
+    }
+}
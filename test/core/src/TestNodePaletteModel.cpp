@@ -0,0 +1,143 @@
+#include "NodePaletteModel.hpp"
+#include "StubDelegateModel.hpp"
+
+#include <QtNodes/NodeDelegateModelRegistry>
+
+#include <catch2/catch.hpp>
+
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodePaletteModel;
+
+namespace {
+
+void registerStub(NodeDelegateModelRegistry &registry, QString const &category, QString const &name)
+{
+    registry.registerModel<StubDelegateModel>(category, name, name);
+}
+
+/// Display text of every row, categories included.
+QStringList rowTexts(NodePaletteModel const &model)
+{
+    QStringList result;
+
+    for (int row = 0; row < model.rowCount(); ++row)
+        result.append(model.index(row).data().toString());
+
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("NodePaletteModel lists and filters registered models", "[palette]")
+{
+    NodeDelegateModelRegistry registry;
+
+    registerStub(registry, "Math", "Subtraction");
+    registerStub(registry, "Math", "Addition");
+    registerStub(registry, "Math", "Multiplication");
+    registerStub(registry, "Math", "Division");
+    registerStub(registry, "Sources", "NumberSource");
+    registerStub(registry, "Displays", "NumberDisplay");
+
+    NodePaletteModel model;
+    model.update(registry);
+
+    SECTION("without a filter categories precede their sorted models")
+    {
+        CHECK(rowTexts(model)
+              == QStringList({"Displays",
+                              "NumberDisplay",
+                              "Math",
+                              "Addition",
+                              "Division",
+                              "Multiplication",
+                              "Subtraction",
+                              "Sources",
+                              "NumberSource"}));
+
+        QModelIndex const category = model.index(0);
+        QModelIndex const entry = model.index(1);
+
+        CHECK(category.data(NodePaletteModel::ModelNameRole).toString().isEmpty());
+        CHECK(model.flags(category) == Qt::ItemIsEnabled);
+
+        CHECK(entry.data(NodePaletteModel::ModelNameRole).toString() == "NumberDisplay");
+        CHECK(entry.data(Qt::ToolTipRole).toString() == "Displays");
+        CHECK(model.flags(entry) == (Qt::ItemIsEnabled | Qt::ItemIsSelectable));
+    }
+
+    SECTION("name prefixes beat word prefixes, which beat substrings")
+    {
+        model.setFilter("di");
+
+        CHECK(rowTexts(model) == QStringList({"Division", "NumberDisplay", "Addition"}));
+
+        model.setFilter("d");
+
+        CHECK(rowTexts(model) == QStringList({"Division", "NumberDisplay", "Addition"}));
+    }
+
+    SECTION("shorter names come first among prefix matches")
+    {
+        model.setFilter("number");
+
+        CHECK(rowTexts(model) == QStringList({"NumberSource", "NumberDisplay"}));
+    }
+
+    SECTION("camel-case words are matched on their own")
+    {
+        model.setFilter("source");
+
+        CHECK(rowTexts(model) == QStringList({"NumberSource"}));
+    }
+
+    SECTION("misspellings match by trigram similarity")
+    {
+        model.setFilter("multiplcation");
+
+        CHECK(rowTexts(model) == QStringList({"Multiplication"}));
+    }
+
+    SECTION("case and surrounding whitespace are ignored")
+    {
+        model.setFilter("  NUMBER ");
+
+        CHECK(rowTexts(model) == QStringList({"NumberSource", "NumberDisplay"}));
+    }
+
+    SECTION("nothing matches")
+    {
+        model.setFilter("xyz");
+
+        CHECK(model.rowCount() == 0);
+    }
+
+    SECTION("clearing the filter restores the categories")
+    {
+        QStringList const unfiltered = rowTexts(model);
+
+        model.setFilter("add");
+        model.setFilter("   ");
+
+        CHECK(rowTexts(model) == unfiltered);
+    }
+
+    SECTION("registry changes are picked up")
+    {
+        int resets = 0;
+
+        QObject::connect(&model, &NodePaletteModel::modelReset, [&resets]() { ++resets; });
+
+        model.setFilter("add");
+        model.update(registry);
+
+        CHECK(resets == 1);
+        CHECK(rowTexts(model) == QStringList({"Addition"}));
+
+        registerStub(registry, "Math", "Add");
+        model.update(registry);
+
+        CHECK(resets == 2);
+        CHECK(rowTexts(model) == QStringList({"Add", "Addition"}));
+    }
+}
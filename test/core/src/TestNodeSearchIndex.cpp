@@ -0,0 +1,152 @@
+#include "StubDelegateModel.hpp"
+
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/NodeDelegateModelRegistry>
+#include <QtNodes/NodeSearchIndex>
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <vector>
+
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodeId;
+using QtNodes::NodeSearchIndex;
+
+namespace {
+
+std::shared_ptr<NodeDelegateModelRegistry> registry()
+{
+    auto ret = std::make_shared<NodeDelegateModelRegistry>();
+
+    ret->registerModel<StubDelegateModel>("Math", QString("Add"), QString("Add"));
+    ret->registerModel<StubDelegateModel>("Math", QString("Addition"), QString("Addition"));
+    ret->registerModel<StubDelegateModel>("Math",
+                                          QString("Multiplication"),
+                                          QString("Multiplication"));
+    ret->registerModel<StubDelegateModel>("Sources",
+                                          QString("NumberSource"),
+                                          QString("Number Source"));
+    ret->registerModel<StubDelegateModel>("Displays",
+                                          QString("NumberDisplay"),
+                                          QString("Number Display"));
+
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("NodeSearchIndex ranks matches", "[search]")
+{
+    DataFlowGraphModel model(registry());
+    NodeSearchIndex index(model);
+
+    NodeId const addition = model.addNode("Addition");
+    NodeId const add = model.addNode("Add");
+    NodeId const multiplication = model.addNode("Multiplication");
+    NodeId const source = model.addNode("NumberSource");
+    NodeId const display = model.addNode("NumberDisplay");
+
+    SECTION("exact matches come before prefix matches")
+    {
+        CHECK(index.search("add") == std::vector<NodeId>{add, addition});
+    }
+
+    SECTION("prefix matches come before fuzzy matches")
+    {
+        // "numbers" prefixes "numbersource" and only resembles "number".
+        CHECK(index.search("numbers") == std::vector<NodeId>{source, display});
+
+        // Both captions contain the word "number": equal scores, ordered by id.
+        CHECK(index.search("num") == std::vector<NodeId>{source, display});
+    }
+
+    SECTION("caption words are matched on their own")
+    {
+        CHECK(index.search("display") == std::vector<NodeId>{display});
+        CHECK(index.search("number display") == std::vector<NodeId>{display, source});
+    }
+
+    SECTION("misspellings match by trigram similarity")
+    {
+        CHECK(index.search("multiplcation") == std::vector<NodeId>{multiplication});
+    }
+
+    SECTION("case and surrounding whitespace are ignored")
+    {
+        CHECK(index.search("  ADD ") == index.search("add"));
+    }
+
+    SECTION("node ids are searchable")
+    {
+        auto const result = index.search(QString::number(display));
+
+        REQUIRE_FALSE(result.empty());
+        CHECK(result.front() == display);
+    }
+
+    SECTION("nothing matches")
+    {
+        CHECK(index.search("xyz").empty());
+        CHECK(index.search("   ").empty());
+        CHECK(index.search("add", 0).empty());
+    }
+}
+
+TEST_CASE("NodeSearchIndex follows the graph model", "[search]")
+{
+    DataFlowGraphModel model(registry());
+    NodeSearchIndex index(model);
+
+    std::vector<NodeId> nodes;
+
+    for (int i = 0; i < 4; ++i)
+        nodes.push_back(model.addNode("Addition"));
+
+    SECTION("results are capped")
+    {
+        CHECK(index.search("addition", 2) == std::vector<NodeId>{nodes[0], nodes[1]});
+        CHECK(index.search("addition").size() == 4);
+    }
+
+    SECTION("deleted nodes are dropped")
+    {
+        index.setTags(nodes[1], {"Accumulator"});
+
+        model.deleteNode(nodes[1]);
+
+        CHECK(index.search("addition") == std::vector<NodeId>{nodes[0], nodes[2], nodes[3]});
+        CHECK(index.search("accumulator").empty());
+        CHECK(index.tags(nodes[1]).isEmpty());
+    }
+
+    SECTION("tags are searchable")
+    {
+        index.setTags(nodes[2], {"Running Total"});
+
+        CHECK(index.tags(nodes[2]) == QStringList{"Running Total"});
+        CHECK(index.search("total") == std::vector<NodeId>{nodes[2]});
+
+        index.setTags(nodes[2], {});
+
+        CHECK(index.search("total").empty());
+    }
+
+    SECTION("tags of missing nodes are ignored")
+    {
+        NodeId const missing = nodes.back() + 1;
+
+        index.setTags(missing, {"Ghost"});
+
+        CHECK(index.tags(missing).isEmpty());
+        CHECK(index.search("ghost").empty());
+    }
+
+    SECTION("existing nodes are indexed on construction")
+    {
+        NodeSearchIndex late(model);
+
+        CHECK(late.search("addition") == index.search("addition"));
+    }
+}
@@ -0,0 +1,151 @@
+#include <QtNodes/SpatialIndex>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using QtNodes::SpatialIndex;
+
+namespace {
+
+std::vector<int> sorted(std::vector<int> keys)
+{
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+} // namespace
+
+TEST_CASE("SpatialIndex insert, update and remove", "[spatial]")
+{
+    SpatialIndex<int> index(100.0);
+
+    index.insert(1, QRectF(0, 0, 10, 10));
+    index.insert(2, QRectF(500, 500, 10, 10));
+
+    REQUIRE(index.size() == 2);
+    CHECK(index.contains(1));
+    CHECK(index.rect(1) == QRectF(0, 0, 10, 10));
+
+    CHECK(index.query(QRectF(-5, -5, 20, 20)) == std::vector<int>{1});
+    CHECK(index.query(QPointF(505, 505)) == std::vector<int>{2});
+    CHECK(index.query(QPointF(50, 50)).empty());
+    CHECK(index.boundingRect() == QRectF(0, 0, 510, 510));
+
+    SECTION("update within the same cell")
+    {
+        index.insert(1, QRectF(2, 2, 10, 10));
+
+        CHECK(index.size() == 2);
+        CHECK(index.rect(1) == QRectF(2, 2, 10, 10));
+        CHECK(index.query(QPointF(11, 11)) == std::vector<int>{1});
+        CHECK(index.query(QPointF(1, 1)).empty());
+    }
+
+    SECTION("update into other cells")
+    {
+        index.insert(1, QRectF(1000, 0, 10, 10));
+
+        CHECK(index.size() == 2);
+        CHECK(index.query(QRectF(-5, -5, 20, 20)).empty());
+        CHECK(index.query(QRectF(995, -5, 20, 20)) == std::vector<int>{1});
+    }
+
+    SECTION("remove")
+    {
+        index.remove(1);
+
+        CHECK(index.size() == 1);
+        CHECK_FALSE(index.contains(1));
+        CHECK(index.rect(1).isNull());
+        CHECK(index.query(QRectF(-5, -5, 20, 20)).empty());
+
+        // Removing an unknown key does nothing.
+        index.remove(42);
+        CHECK(index.size() == 1);
+    }
+
+    SECTION("clear")
+    {
+        index.clear();
+
+        CHECK(index.size() == 0);
+        CHECK(index.query(QRectF(-1000, -1000, 3000, 3000)).empty());
+    }
+}
+
+TEST_CASE("SpatialIndex reports rects straddling cell boundaries once", "[spatial]")
+{
+    SpatialIndex<int> index(100.0);
+
+    // Covers the four cells around (100, 100).
+    index.insert(1, QRectF(90, 90, 20, 20));
+    index.insert(2, QRectF(150, 150, 10, 10));
+
+    SECTION("query covering every cell of the rect")
+    {
+        CHECK(sorted(index.query(QRectF(0, 0, 200, 200))) == std::vector<int>{1, 2});
+    }
+
+    SECTION("query starting inside the rect")
+    {
+        CHECK(index.query(QRectF(105, 105, 1, 1)) == std::vector<int>{1});
+        CHECK(index.query(QRectF(100, 50, 50, 50)) == std::vector<int>{1});
+    }
+
+    SECTION("query sharing cells but not the rect")
+    {
+        CHECK(index.query(QRectF(95, 0, 1, 50)).empty());
+    }
+
+    SECTION("query covering more cells than are populated")
+    {
+        CHECK(sorted(index.query(QRectF(-1e5, -1e5, 2e5, 2e5))) == std::vector<int>{1, 2});
+    }
+
+    SECTION("negative coordinates")
+    {
+        index.insert(3, QRectF(-110, -110, 20, 20));
+
+        CHECK(index.query(QRectF(-200, -200, 150, 150)) == std::vector<int>{3});
+        CHECK(index.query(QPointF(-100, -100)) == std::vector<int>{3});
+    }
+}
+
+TEST_CASE("SpatialIndex keeps oversized entries apart", "[spatial]")
+{
+    SpatialIndex<int> index(10.0);
+
+    // 101 x 101 cells, far above the per-entry cell limit.
+    index.insert(1, QRectF(0, 0, 1000, 1000));
+    index.insert(2, QRectF(5, 5, 1, 1));
+
+    CHECK(index.query(QPointF(500, 500)) == std::vector<int>{1});
+    CHECK(sorted(index.query(QRectF(4, 4, 3, 3))) == std::vector<int>{1, 2});
+    CHECK(index.query(QRectF(2000, 2000, 1, 1)).empty());
+
+    SECTION("shrinking an oversized entry")
+    {
+        index.insert(1, QRectF(2000, 2000, 1, 1));
+
+        CHECK(index.query(QPointF(500, 500)).empty());
+        CHECK(index.query(QRectF(1999, 1999, 3, 3)) == std::vector<int>{1});
+    }
+
+    SECTION("growing an entry into an oversized one")
+    {
+        index.insert(2, QRectF(-1000, -1000, 900, 900));
+
+        CHECK(index.query(QPointF(5.5, 5.5)) == std::vector<int>{1});
+        CHECK(index.query(QPointF(-500, -500)) == std::vector<int>{2});
+    }
+
+    SECTION("removing an oversized entry")
+    {
+        index.remove(1);
+
+        CHECK(index.query(QPointF(500, 500)).empty());
+        CHECK(index.query(QRectF(4, 4, 3, 3)) == std::vector<int>{2});
+    }
+}